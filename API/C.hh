@@ -44,10 +44,28 @@ extern "C" {
 		SAFE_DELETE(g_Graphiti);
 	}
 
+	void createOffscreenWindow(const char* title, int width, int height)
+	{
+		LOG("[API] createOffscreenWindow('%s', %i, %i);\n", title, width, height);
+		g_Graphiti->createOffscreenWindow(title, width, height);
+	}
+
 	void screenshot(const char* filename)
 	{
 	    // LOG("[API] screenshot(%s)\n", filename);
-		// TODO : g_Graphiti->screenshot(filename);
+		g_Graphiti->screenshot(filename);
+	}
+
+	void record(const char* prefix, unsigned int frames)
+	{
+	    LOG("[API] record('%s', %u)\n", prefix, frames);
+		g_Graphiti->record(prefix, frames);
+	}
+
+	bool dumpTrace(const char* filename)
+	{
+	    LOG("[API] dumpTrace('%s')\n", filename);
+		return Profiler::getInstance().dump(filename);
 	}
 
 	// ----- Entities -----
@@ -81,12 +99,55 @@ extern "C" {
     void setAttribute(const char* name, const char* type, const char* value)
     {
         // LOG("[API] setAttribute('%s', '%s', '%s')\n", name, type, value);
+
+        // NOTE : Stats aren't bound to an entity
+        if (std::string(name) == "og:stats:overlay")
+        {
+            BooleanVariable vbool;
+            vbool.set(value);
+            Stats::getInstance().Overlay = vbool.value();
+            return;
+        }
+        else if (std::string(name) == "og:scheduler:timestep")
+        {
+            FloatVariable vfloat;
+            vfloat.set(value);
+            if (vfloat.value() > 0)
+                g_Graphiti->scheduler().TimeStep = vfloat.value();
+            return;
+        }
+        else if (std::string(name) == "og:queue:budget")
+        {
+            FloatVariable vfloat;
+            vfloat.set(value);
+            if (vfloat.value() > 0)
+                g_Graphiti->CommandBudget = vfloat.value();
+            return;
+        }
+        else if (std::string(name) == "og:scheduler:substeps")
+        {
+            IntVariable vint;
+            vint.set(value);
+            if (vint.value() > 0)
+                g_Graphiti->scheduler().MaxSubsteps = vint.value();
+            return;
+        }
+
         return g_Graphiti->entities().active()->setAttribute(name, type, value);
     }
 
     IVariable* getAttribute(const char* name)
     {
         // LOG("[API] getAttribute('%s')\n", name);
+
+        // NOTE : Stats aren't bound to an entity, they are returned as a JSON string
+        if (std::string(name) == "og:stats")
+        {
+            StringVariable* variable = new StringVariable();
+            variable->set(Stats::getInstance().report());
+            return variable;
+        }
+
         return g_Graphiti->entities().active()->getAttribute(name);
     }
 
@@ -1,6 +1,10 @@
 #pragma once
 
 #include "Entities/Graph/GraphCommands.hh"
+#include "Core/CommandQueue.hh"
+
+#include <algorithm>
+#include <stdexcept>
 
 namespace API {
 namespace Graph {
@@ -11,7 +15,7 @@ inline GraphEntity* getActiveGraph()
     if (entity->type() != Entity::GRAPH)
     {
         LOG("[API] Active entity is not a graph!\n");
-        throw;
+        throw std::runtime_error("active entity is not a graph");
     }
     return static_cast<GraphEntity*>(entity);
 }
@@ -178,15 +182,11 @@ extern "C"
 
     // ----- Commands -----
 
-    Sequence::ID sendCommand(Timecode timecode, const char* name, const Variables& variables)
+    GraphCommand* createCommand(GraphEntity* graph, const char* name, const Variables& variables)
     {
-        Sequence* command = NULL;
+        GraphCommand* command = NULL;
         std::string sname = std::string(name);
 
-        // LOG("[API] sendCommand(%lu, '%s', %p)\n", timecode, name, &variables);
-
-        GraphEntity* graph = getActiveGraph();
-
         if (sname == "graph:set_attribute")
             command = GraphCommandFactory::SetAttribute(graph, variables);
         else if (sname == "graph:add_node")
@@ -207,13 +207,93 @@ extern "C"
         if (command == NULL)
         {
             LOG("[API] Couldn't create command.\n");
-            throw;
+            throw std::runtime_error("invalid command");
         }
 
+        return command;
+    }
+
+    Sequence::ID sendCommand(Timecode timecode, const char* name, const Variables& variables)
+    {
+        // LOG("[API] sendCommand(%lu, '%s', %p)\n", timecode, name, &variables);
+
+        GraphEntity* graph = getActiveGraph();
+        GraphCommand* command = createCommand(graph, name, variables);
+        Sequence::ID id = command->id();
+
         graph->context()->sequencer().track("command")->insert(command, Track::Event::ONCE, timecode);
-        // TODO : Find a way to not overload the scheduler when we load a lot of commands at once
-        graph->context()->messages().push(new SequencerMessage("command", "update"));
-        return command->id();
+        // NOTE : Updates are coalesced, the scheduler sees a single one per batch of commands
+        if (static_cast<GraphContext*>(graph->context())->requestCommandUpdate())
+            graph->context()->messages().push(new SequencerMessage("command", "update"));
+        return id;
+    }
+
+    // NOTE : Encodes every command before touching the track, nothing is inserted if one of them is invalid.
+    // Timelines usually come time-ordered, they are only sorted when they aren't. Records are packed in the
+    // arena of the track, each run of records sharing a timecode is played by a single GraphCommandBlock.
+    // Inserting blocks in time order keeps every insertion at the end of the track, and the scheduler is
+    // notified once for the whole batch. Commands sharing a timecode share the ID of its first block.
+    void sendCommands(const std::vector<Timecode>& timecodes, const std::vector<std::string>& names,
+                      const std::vector<Variables*>& variables, std::vector<Sequence::ID>& ids)
+    {
+        // LOG("[API] sendCommands(%lu commands)\n", (unsigned long) names.size());
+
+        GraphEntity* graph = getActiveGraph();
+        GraphContext* context = static_cast<GraphContext*>(graph->context());
+
+        std::vector<unsigned long> order(names.size());
+        for (unsigned long i = 0; i < order.size(); i++)
+            order[i] = i;
+
+        auto earlier = [&timecodes](unsigned long a, unsigned long b) { return timecodes[a] < timecodes[b]; };
+        if (!std::is_sorted(order.begin(), order.end(), earlier))
+            std::stable_sort(order.begin(), order.end(), earlier);
+
+        GraphCommandBatch batch;
+        batch.reserve(names.size());
+
+        for (auto i : order)
+        {
+            if (!batch.add(timecodes[i], names[i], *variables[i]))
+            {
+                LOG("[API] Couldn't create command %lu ('%s'), no command was sent.\n", i, names[i].c_str());
+                throw std::runtime_error("invalid command in batch");
+            }
+        }
+
+        batch.coalesce();
+
+        std::vector<GraphCommandBlock*> blocks;
+        batch.commit(graph, context->commandArena(), blocks);
+
+        // NOTE : Every timecode keeps at least one record, so each has a block. IDs are read before the
+        // blocks are inserted, the track owns them from then on and may play and release them right away.
+        ids.resize(names.size());
+        unsigned long b = 0;
+        for (auto i : order)
+        {
+            while (blocks[b]->time() < timecodes[i])
+                b++;
+            ids[i] = blocks[b]->id();
+        }
+
+        auto track = context->sequencer().track("command");
+        for (auto block : blocks)
+            track->insert(block, Track::Event::ONCE, block->time());
+
+        if (!blocks.empty() && context->requestCommandUpdate())
+            context->messages().push(new SequencerMessage("command", "update"));
+    }
+
+    // NOTE : Safe to call from any thread. The command is played once by the main loop, in posting order,
+    // instead of going through the sequencer. It is built and validated here, so an invalid command throws
+    // on the caller's thread and is never queued.
+    void postCommand(const char* name, const Variables& variables)
+    {
+        // LOG("[API] postCommand('%s', %p)\n", name, &variables);
+
+        GraphCommand* command = createCommand(getActiveGraph(), name, variables);
+        CommandQueue::getInstance().post(command);
     }
 }
 }
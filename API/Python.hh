@@ -182,6 +182,20 @@ static PyObject* createWindow(PyObject* self, PyObject* args)
 	return Py_BuildValue("");
 }
 
+static PyObject* createOffscreenWindow(PyObject* self, PyObject* args)
+{
+	(void)self;
+
+	char* title = NULL;
+	int width, height;
+
+	PROTECT_PARSE(PyArg_ParseTuple(args, "sii", &title, &width, &height));
+
+	API::createOffscreenWindow(title, width, height);
+
+	return Py_BuildValue("");
+}
+
 static PyObject* createVisualizer(PyObject* self, PyObject* args)
 {
 	(void)self;
@@ -208,6 +222,31 @@ static PyObject* screenshot(PyObject* self, PyObject* args)
 	return Py_BuildValue("");
 }
 
+static PyObject* dumpTrace(PyObject* self, PyObject* args)
+{
+	char* filename = NULL;
+
+	(void)self;
+
+	PROTECT_PARSE(PyArg_ParseTuple(args, "s", &filename))
+
+	return PyBool_FromLong(API::dumpTrace(filename) ? 1 : 0);
+}
+
+static PyObject* record(PyObject* self, PyObject* args)
+{
+	char* prefix = NULL;
+	unsigned int frames = 0;
+
+	(void)self;
+
+	PROTECT_PARSE(PyArg_ParseTuple(args, "sI", &prefix, &frames))
+
+	API::record(prefix, frames);
+
+	return Py_BuildValue("");
+}
+
 // ----- Entities -----
 
 static PyObject* createEntity(PyObject* self, PyObject* args)
@@ -627,6 +666,104 @@ static PyObject* sendCommand(PyObject* self, PyObject* args)
     return cid;
 }
 
+// NOTE : Takes a list of (timecode, name, attributes) tuples, returns the list of command IDs
+static PyObject* sendCommands(PyObject* self, PyObject* args)
+{
+    (void) self;
+
+    PyObject* list;
+
+    PROTECT_PARSE(PyArg_ParseTuple(args, "O", &list))
+
+    PyObject* sequence = PySequence_Fast(list, "send_commands expects a list of (timecode, name, attributes) tuples");
+    if (sequence == NULL)
+        return NULL;
+
+    Py_ssize_t size = PySequence_Fast_GET_SIZE(sequence);
+
+    std::vector<Timecode> timecodes;
+    std::vector<std::string> names;
+    std::vector<Variables*> variables;
+    timecodes.reserve(size);
+    names.reserve(size);
+    variables.reserve(size);
+
+    PyObject* result = NULL;
+
+    for (Py_ssize_t i = 0; i < size; i++)
+    {
+        Timecode timecode;
+        char* name = NULL;
+        PyObject* dict;
+
+        if (!PyArg_ParseTuple(PySequence_Fast_GET_ITEM(sequence, i), "ksO", &timecode, &name, &dict))
+            goto cleanup;
+
+        Variables* vars = convertPyDictToVariables(dict);
+        if (vars == NULL)
+        {
+            LOG("[PYTHON] send_commands : Command %li has no attribute dictionary!\n", (long) i);
+            result = Py_BuildValue("");
+            goto cleanup;
+        }
+
+        timecodes.push_back(timecode);
+        names.push_back(std::string(name));
+        variables.push_back(vars);
+    }
+
+    try
+    {
+        std::vector<Sequence::ID> ids;
+        API::Graph::sendCommands(timecodes, names, variables, ids);
+
+        result = PyList_New(ids.size());
+        for (unsigned long i = 0; i < ids.size(); i++)
+            PyList_SET_ITEM(result, i, PyLong_FromLong(ids[i]));
+    }
+    catch (std::exception& e)
+    {
+        // NOTE : Nothing was inserted, the whole batch is rejected
+        result = Py_BuildValue("");
+    }
+
+cleanup:
+    for (auto vars : variables)
+        delete vars;
+    Py_DECREF(sequence);
+
+    return result;
+}
+
+static PyObject* postCommand(PyObject* self, PyObject* args)
+{
+    (void) self;
+    PyObject* result;
+
+    char* name = NULL;
+    PyObject* dict;
+
+    PROTECT_PARSE(PyArg_ParseTuple(args, "sO", &name, &dict))
+
+    Variables* vars = convertPyDictToVariables(dict);
+    if (vars == NULL)
+        return Py_BuildValue("");
+
+    try
+    {
+        API::Graph::postCommand(name, *vars);
+        result = PyBool_FromLong(1);
+    }
+    catch (std::exception& e)
+    {
+        result = PyBool_FromLong(0);
+    }
+
+    delete vars;
+
+    return result;
+}
+
 }
 
 // ----- Scripts -----
@@ -688,7 +825,10 @@ static PyMethodDef g_Module[] =
 	{"start",                 API::Python::start,               METH_VARARGS, "Start engine"},
 	{"create_window",         API::Python::createWindow,        METH_VARARGS, "Create window"},
 	{"create_visualizer",     API::Python::createVisualizer,    METH_VARARGS, "Create visualizer"},
+	{"create_offscreen_window", API::Python::createOffscreenWindow, METH_VARARGS, "Create a hidden window rendering into an offscreen target"},
 	{"screenshot",            API::Python::screenshot,          METH_VARARGS, "Take a screenshot"},
+	{"record",                API::Python::record,              METH_VARARGS, "Save the next frames as a PNG sequence"},
+	{"dump_trace",            API::Python::dumpTrace,           METH_VARARGS, "Write the profiling zones as Chrome trace-event JSON"},
     // ----- Entities -----
     {"create_entity",         API::Python::createEntity,        METH_VARARGS, "Create an entity"},
     {"bind_entity",           API::Python::bindEntity,          METH_VARARGS, "Create an entity"},
@@ -732,6 +872,8 @@ static PyMethodDef g_Module[] =
         {"get_selected_node",     API::Python::Graph::getSelectedNode,     METH_VARARGS, "Get a selected node"},
         // ----- Commands -----
         {"send_command",          API::Python::Graph::sendCommand,         METH_VARARGS, "Send a command"},
+        {"send_commands",         API::Python::Graph::sendCommands,        METH_VARARGS, "Send a time-ordered list of commands"},
+        {"post_command",          API::Python::Graph::postCommand,         METH_VARARGS, "Post a command from any thread"},
 
 	{NULL, NULL, 0, NULL}
 };
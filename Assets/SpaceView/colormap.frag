@@ -0,0 +1,34 @@
+#ifdef GL_ES
+precision mediump float;
+#endif
+
+uniform sampler2D u_Density;
+uniform float u_Range;
+
+varying vec2 v_Texcoord;
+
+vec3 colormap(float t)
+{
+    vec3 c0 = vec3(0.0, 0.0, 0.2);
+    vec3 c1 = vec3(0.5, 0.0, 0.5);
+    vec3 c2 = vec3(1.0, 0.4, 0.0);
+    vec3 c3 = vec3(1.0, 1.0, 0.8);
+
+    if (t < 0.33)
+        return mix(c0, c1, t / 0.33);
+    else if (t < 0.66)
+        return mix(c1, c2, (t - 0.33) / 0.33);
+    return mix(c2, c3, (t - 0.66) / 0.34);
+}
+
+void main(void)
+{
+    float density = texture2D(u_Density, v_Texcoord).r;
+    if (density <= 0.0)
+        discard;
+
+    // NOTE : Logarithmic scaling keeps both sparse and dense regions readable
+    float t = clamp(log(1.0 + density) / log(1.0 + u_Range), 0.0, 1.0);
+
+    gl_FragColor = vec4(colormap(t), clamp(4.0 * t, 0.0, 1.0));
+}
@@ -0,0 +1,9 @@
+attribute vec2 a_Position;
+
+varying vec2 v_Texcoord;
+
+void main(void)
+{
+    v_Texcoord = 0.5 * (a_Position + vec2(1.0, 1.0));
+    gl_Position = vec4(a_Position, 0.0, 1.0);
+}
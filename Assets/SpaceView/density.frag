@@ -0,0 +1,15 @@
+#ifdef GL_ES
+precision mediump float;
+#endif
+
+void main(void)
+{
+    vec2 p = 2.0 * gl_PointCoord - vec2(1.0, 1.0);
+    float r2 = dot(p, p);
+    if (r2 > 1.0)
+        discard;
+
+    // NOTE : Gaussian kernel, accumulated additively
+    float weight = exp(-4.0 * r2);
+    gl_FragColor = vec4(weight, weight, weight, 1.0);
+}
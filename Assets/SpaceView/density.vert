@@ -0,0 +1,21 @@
+attribute vec3 a_Position;
+attribute float a_LOD;
+attribute float a_Weight;
+
+uniform mat4 u_ModelViewProjection;
+uniform float u_KernelSize;
+uniform vec3 u_LOD;
+
+void main(void)
+{
+    if (a_Weight <= 0.0 || (u_LOD.x > 0.5 && (a_LOD < u_LOD.y || a_LOD > u_LOD.z)))
+    {
+        // NOTE : Push the vertex out of the clip volume
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        gl_PointSize = 1.0;
+        return;
+    }
+
+    gl_Position = u_ModelViewProjection * vec4(a_Position, 1.0);
+    gl_PointSize = u_KernelSize;
+}
@@ -0,0 +1,17 @@
+#ifdef GL_ES
+precision mediump float;
+#endif
+
+uniform float u_Mode;
+uniform sampler2D u_Texture;
+
+varying vec2 v_Texcoord;
+varying vec4 v_Color;
+
+void main(void)
+{
+    if (u_Mode > 0.5)
+        gl_FragColor = v_Color * texture2D(u_Texture, v_Texcoord);
+    else
+        gl_FragColor = v_Color;
+}
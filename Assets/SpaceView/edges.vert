@@ -0,0 +1,74 @@
+attribute vec3 a_Start;
+attribute vec3 a_End;
+attribute vec2 a_Corner;
+attribute vec4 a_Color1;
+attribute vec4 a_Color2;
+attribute vec4 a_Params;
+
+uniform mat4 u_ModelViewProjection;
+uniform mat4 u_ViewMatrix;
+uniform vec3 u_CameraPosition;
+uniform float u_EdgeSize;
+uniform float u_Time;
+uniform float u_Mode; // NOTE : 0 = Lines, 1 = Wide Lines, 2 = Activity
+uniform float u_Style;
+uniform vec3 u_LOD;
+
+varying vec2 v_Texcoord;
+varying vec4 v_Color;
+
+void main(void)
+{
+    float width = a_Params.x;
+    float lod = a_Params.y;
+    float style = a_Params.z;
+    float activity = a_Params.w;
+
+    bool hidden = style < 0.0;
+    hidden = hidden || (u_LOD.x > 0.5 && (lod < u_LOD.y || lod > u_LOD.z));
+    hidden = hidden || (u_Mode > 0.5 && u_Mode < 1.5 && abs(style - u_Style) > 0.5);
+    hidden = hidden || (u_Mode > 1.5 && activity <= 0.0);
+
+    v_Texcoord = vec2(a_Corner.x, 0.5 * (a_Corner.y + 1.0));
+
+    if (hidden)
+    {
+        // NOTE : Push the vertex out of the clip volume
+        v_Color = vec4(0.0);
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+
+    vec3 position;
+
+    if (u_Mode > 1.5)
+    {
+        float t = fract(activity * u_Time);
+        float size = 2.0 * u_EdgeSize;
+
+        vec3 right = vec3(u_ViewMatrix[0][0], u_ViewMatrix[1][0], u_ViewMatrix[2][0]);
+        vec3 up = vec3(u_ViewMatrix[0][1], u_ViewMatrix[1][1], u_ViewMatrix[2][1]);
+
+        v_Color = mix(a_Color1, a_Color2, t);
+
+        position = mix(a_Start, a_End, t);
+        position += size * (a_Corner.x - 0.5) * right;
+        position += size * 0.5 * a_Corner.y * up;
+    }
+    else
+    {
+        v_Color = mix(a_Color1, a_Color2, a_Corner.x);
+
+        position = mix(a_Start, a_End, a_Corner.x);
+
+        if (u_Mode > 0.5)
+        {
+            vec3 direction = cross(a_End - a_Start, u_CameraPosition - 0.5 * (a_Start + a_End));
+            float norm = length(direction);
+            if (norm > 0.0)
+                position += (0.25 * u_EdgeSize * width * a_Corner.y / norm) * direction;
+        }
+    }
+
+    gl_Position = u_ModelViewProjection * vec4(position, 1.0);
+}
@@ -0,0 +1,14 @@
+#ifdef GL_ES
+precision mediump float;
+#endif
+
+varying vec4 v_Color;
+
+void main(void)
+{
+    vec2 p = 2.0 * gl_PointCoord - vec2(1.0, 1.0);
+    if (dot(p, p) > 1.0)
+        discard;
+
+    gl_FragColor = v_Color;
+}
@@ -0,0 +1,26 @@
+attribute vec3 a_Position;
+attribute float a_Radius;
+attribute vec4 a_Color;
+attribute float a_LOD;
+
+uniform mat4 u_ModelViewProjection;
+uniform float u_PixelScale;
+uniform vec3 u_LOD;
+
+varying vec4 v_Color;
+
+void main(void)
+{
+    v_Color = a_Color;
+
+    if (a_Radius <= 0.0 || (u_LOD.x > 0.5 && (a_LOD < u_LOD.y || a_LOD > u_LOD.z)))
+    {
+        // NOTE : Push the vertex out of the clip volume
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        gl_PointSize = 1.0;
+        return;
+    }
+
+    gl_Position = u_ModelViewProjection * vec4(a_Position, 1.0);
+    gl_PointSize = max(1.0, 2.0 * a_Radius * u_PixelScale / gl_Position.w);
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <raindance/Core/Headers.hh>
+#include <raindance/Core/Sequencer/Sequencer.hh>
+
+#include <atomic>
+#include <chrono>
+
+// NOTE : Lock-free multi-producer single-consumer queue of commands. Any thread may post, only the main loop
+// processes them, within a time budget so that a burst of posts can't freeze rendering. This is a Vyukov
+// intrusive queue: posting is a single exchange, and a node whose producer was preempted halfway simply
+// stays invisible until that producer resumes.
+//
+// Nodes are recycled. The main loop pushes processed nodes on a free stack, producers take the whole stack
+// at once into a thread local cache. Nothing ever pops a single node from the shared stack, so there is no
+// ABA problem.
+class CommandQueue
+{
+public:
+    static CommandQueue& getInstance()
+    {
+        // NOTE : Never destroyed, thread caches may hand their nodes back after static destruction began
+        static CommandQueue* s_Instance = new CommandQueue();
+        return *s_Instance;
+    }
+
+    // NOTE : Takes ownership of the command, it is played once on the main loop and deleted
+    void post(Sequence* command)
+    {
+        Node* node = acquire();
+        node->Command = command;
+        node->Next.store(NULL, std::memory_order_relaxed);
+
+        Node* previous = m_Head.exchange(node, std::memory_order_acq_rel);
+        previous->Next.store(node, std::memory_order_release);
+
+        // NOTE : Wake the main loop up if it is waiting for events
+        if (m_Size.fetch_add(1, std::memory_order_relaxed) == 0)
+        {
+#if !defined(EMSCRIPTEN) && (GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 1))
+            glfwPostEmptyEvent();
+#endif
+        }
+    }
+
+    // NOTE : Main loop only. Posted commands aren't scheduled, they are played with a null timecode.
+    // Returns the number of commands played.
+    unsigned long process(double budget)
+    {
+        auto start = std::chrono::steady_clock::now();
+        unsigned long count = 0;
+
+        Sequence* command;
+        while ((command = pop()) != NULL)
+        {
+            command->play(0);
+            delete command;
+            count++;
+
+            // NOTE : The clock is only read every few commands
+            if ((count & 63) == 0 && std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() > budget)
+                break;
+        }
+
+        return count;
+    }
+
+    // NOTE : Approximate while producers are posting
+    inline unsigned long size() const { return m_Size.load(std::memory_order_relaxed); }
+
+private:
+    struct Node
+    {
+        std::atomic<Node*> Next;
+        Sequence* Command;
+    };
+
+    struct Cache
+    {
+        Cache() : Head(NULL) {}
+
+        ~Cache()
+        {
+            while (Head != NULL)
+            {
+                Node* node = Head;
+                Head = node->Next.load(std::memory_order_relaxed);
+                CommandQueue::getInstance().release(node);
+            }
+        }
+
+        Node* Head;
+    };
+
+    CommandQueue()
+    : m_Head(&m_Stub), m_Tail(&m_Stub), m_Size(0), m_Free(NULL)
+    {
+        m_Stub.Next.store(NULL, std::memory_order_relaxed);
+        m_Stub.Command = NULL;
+    }
+
+    Sequence* pop()
+    {
+        Node* tail = m_Tail;
+        Node* next = tail->Next.load(std::memory_order_acquire);
+
+        if (tail == &m_Stub)
+        {
+            if (next == NULL)
+                return NULL;
+            m_Tail = next;
+            tail = next;
+            next = next->Next.load(std::memory_order_acquire);
+        }
+
+        if (next == NULL)
+        {
+            // NOTE : Either the queue holds a single node, or a producer hasn't linked its node yet
+            if (tail != m_Head.load(std::memory_order_acquire))
+                return NULL;
+
+            m_Stub.Next.store(NULL, std::memory_order_relaxed);
+            Node* previous = m_Head.exchange(&m_Stub, std::memory_order_acq_rel);
+            previous->Next.store(&m_Stub, std::memory_order_release);
+
+            next = tail->Next.load(std::memory_order_acquire);
+            if (next == NULL)
+                return NULL;
+        }
+
+        m_Tail = next;
+
+        Sequence* command = tail->Command;
+        release(tail);
+        m_Size.fetch_sub(1, std::memory_order_relaxed);
+        return command;
+    }
+
+    Node* acquire()
+    {
+        static thread_local Cache t_Cache;
+
+        if (t_Cache.Head == NULL)
+            t_Cache.Head = m_Free.exchange(NULL, std::memory_order_acquire);
+
+        if (t_Cache.Head == NULL)
+            return new Node();
+
+        Node* node = t_Cache.Head;
+        t_Cache.Head = node->Next.load(std::memory_order_relaxed);
+        return node;
+    }
+
+    void release(Node* node)
+    {
+        Node* head = m_Free.load(std::memory_order_relaxed);
+        do
+            node->Next.store(head, std::memory_order_relaxed);
+        while (!m_Free.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    Node m_Stub;
+    std::atomic<Node*> m_Head; // NOTE : Producers push here
+    Node* m_Tail;              // NOTE : The consumer pops from here
+    std::atomic<unsigned long> m_Size;
+    std::atomic<Node*> m_Free;
+};
@@ -2,6 +2,8 @@
 
 #include <raindance/Core/Context.hh>
 
+#include "Core/Profiler.hh"
+
 #if EMSCRIPTEN
 # include <emscripten.h>
 # include <raindance/Core/Console/JavascriptConsole.hh>
@@ -51,6 +53,7 @@ public:
 			return;
 		}
 
+		PROFILE_ZONE("Console::execute");
 		execute(script);
 	}
 };
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <raindance/Core/Headers.hh>
+
+// NOTE : Vertex buffer made of fixed-size slots, one slot per visual element. Slots are
+// recycled when released, and only the slot ranges touched since the last upload are
+// sent to the GPU.
+class DynamicBuffer
+{
+public:
+    typedef unsigned long Slot;
+
+    static const Slot InvalidSlot = (Slot) -1;
+
+    struct Attribute
+    {
+        std::string Name;
+        GLint Size;
+        GLenum Type;
+        GLboolean Normalized;
+        unsigned long Offset;
+        GLint Location;
+    };
+
+    DynamicBuffer(unsigned long vertexSize, unsigned long verticesPerSlot)
+    : m_VertexSize(vertexSize), m_VerticesPerSlot(verticesPerSlot)
+    {
+        m_SlotSize = vertexSize * verticesPerSlot;
+        m_Count = 0;
+        m_VBO = 0;
+        m_UploadedCapacity = 0;
+        m_Program = 0;
+    }
+
+    virtual ~DynamicBuffer()
+    {
+        if (m_VBO != 0)
+            glDeleteBuffers(1, &m_VBO);
+    }
+
+    void describe(const char* name, GLint size, GLenum type, GLboolean normalized, unsigned long offset)
+    {
+        Attribute attribute;
+        attribute.Name = std::string(name);
+        attribute.Size = size;
+        attribute.Type = type;
+        attribute.Normalized = normalized;
+        attribute.Offset = offset;
+        attribute.Location = -1;
+        m_Attributes.push_back(attribute);
+    }
+
+    void reserve(unsigned long slots)
+    {
+        if (slots * m_SlotSize > m_Data.size())
+        {
+            m_Data.resize(slots * m_SlotSize, 0);
+            m_DirtyFlags.resize(slots, false);
+        }
+    }
+
+    Slot allocate()
+    {
+        Slot slot;
+
+        if (!m_FreeSlots.empty())
+        {
+            slot = m_FreeSlots.back();
+            m_FreeSlots.pop_back();
+        }
+        else
+        {
+            slot = m_Count++;
+            if (m_Count * m_SlotSize > m_Data.size())
+                reserve(m_Count < 1024 ? 1024 : 2 * m_Count);
+        }
+
+        touch(slot);
+        return slot;
+    }
+
+    void release(Slot slot)
+    {
+        m_FreeSlots.push_back(slot);
+        touch(slot);
+    }
+
+    inline void touch(Slot slot)
+    {
+        if (!m_DirtyFlags[slot])
+        {
+            m_DirtyFlags[slot] = true;
+            m_DirtySlots.push_back(slot);
+        }
+    }
+
+    void touchAll()
+    {
+        for (Slot slot = 0; slot < m_Count; slot++)
+            touch(slot);
+    }
+
+    void upload()
+    {
+        const unsigned long c_MaxGap = 16; // NOTE : Merge dirty runs separated by fewer clean slots than this
+
+        if (m_VBO == 0)
+            glGenBuffers(1, &m_VBO);
+
+        glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+
+        if (m_UploadedCapacity * m_SlotSize != m_Data.size())
+        {
+            // NOTE : Storage grew, the whole buffer needs to be reallocated.
+            glBufferData(GL_ARRAY_BUFFER, m_Data.size(), m_Data.data(), GL_DYNAMIC_DRAW);
+            m_UploadedCapacity = m_Data.size() / m_SlotSize;
+        }
+        else if (2 * m_DirtySlots.size() > m_Count)
+        {
+            glBufferSubData(GL_ARRAY_BUFFER, 0, m_Count * m_SlotSize, m_Data.data());
+        }
+        else if (!m_DirtySlots.empty())
+        {
+            std::sort(m_DirtySlots.begin(), m_DirtySlots.end());
+
+            Slot first = m_DirtySlots[0];
+            Slot last = first;
+
+            for (unsigned long i = 1; i <= m_DirtySlots.size(); i++)
+            {
+                if (i < m_DirtySlots.size() && m_DirtySlots[i] - last <= c_MaxGap)
+                {
+                    last = m_DirtySlots[i];
+                    continue;
+                }
+
+                glBufferSubData(GL_ARRAY_BUFFER, first * m_SlotSize, (last - first + 1) * m_SlotSize, m_Data.data() + first * m_SlotSize);
+
+                if (i < m_DirtySlots.size())
+                    first = last = m_DirtySlots[i];
+            }
+        }
+
+        for (auto slot : m_DirtySlots)
+            m_DirtyFlags[slot] = false;
+        m_DirtySlots.clear();
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // NOTE : Binds the vertex attributes against the program currently in use. Without base vertex draws
+    // (GLES 2, WebGL), a range of the buffer is addressed by binding the attributes from its first vertex.
+    void bind(unsigned long first = 0)
+    {
+        GLint program = 0;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+
+        if (static_cast<GLuint>(program) != m_Program)
+        {
+            for (auto& attribute : m_Attributes)
+                attribute.Location = glGetAttribLocation(program, attribute.Name.c_str());
+            m_Program = program;
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+        for (auto& attribute : m_Attributes)
+        {
+            if (attribute.Location < 0)
+                continue;
+            glEnableVertexAttribArray(attribute.Location);
+            glVertexAttribPointer(attribute.Location, attribute.Size, attribute.Type, attribute.Normalized, m_VertexSize, (const GLvoid*) (first * m_VertexSize + attribute.Offset));
+        }
+    }
+
+    void unbind()
+    {
+        for (auto& attribute : m_Attributes)
+            if (attribute.Location >= 0)
+                glDisableVertexAttribArray(attribute.Location);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    template <class T>
+    inline T* vertices(Slot slot) { return reinterpret_cast<T*>(m_Data.data() + slot * m_SlotSize); }
+
+    inline unsigned long count() const { return m_Count; }
+    inline unsigned long capacity() const { return m_Data.size() / m_SlotSize; }
+    inline unsigned long verticesPerSlot() const { return m_VerticesPerSlot; }
+    inline unsigned long countDirty() const { return m_DirtySlots.size(); }
+
+private:
+    unsigned long m_VertexSize;
+    unsigned long m_VerticesPerSlot;
+    unsigned long m_SlotSize;
+    unsigned long m_Count;
+
+    std::vector<unsigned char> m_Data;
+    std::vector<Slot> m_FreeSlots;
+    std::vector<Slot> m_DirtySlots;
+    std::vector<bool> m_DirtyFlags;
+    std::vector<Attribute> m_Attributes;
+
+    GLuint m_VBO;
+    unsigned long m_UploadedCapacity;
+    GLuint m_Program;
+};
+
+// NOTE : Bound to const references when slot maps are resized, the constant needs storage
+const DynamicBuffer::Slot DynamicBuffer::InvalidSlot;
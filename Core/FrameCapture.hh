@@ -0,0 +1,241 @@
+#pragma once
+
+#include <raindance/Core/Headers.hh>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+#include "Core/PNG.hh"
+
+// NOTE : Captures drawn frames to PNG files without stalling the main loop. Pixels are read into a
+// pixel buffer object and mapped one frame later, once the transfer is done. Encoding and writing
+// happen on a worker thread. WebGL has no pixel buffer objects and the web build has no threads, frames
+// are read and encoded synchronously there.
+class FrameCapture
+{
+public:
+    struct Image
+    {
+        std::string Filename;
+        int Width;
+        int Height;
+        std::vector<unsigned char> Pixels;
+    };
+
+    FrameCapture()
+    {
+#ifndef EMSCRIPTEN
+        m_Running = true;
+        m_Worker = std::thread(&FrameCapture::work, this);
+#endif
+
+        m_PBO[0] = m_PBO[1] = 0;
+        m_PBOSize = 0;
+        m_Current = 0;
+        m_Pending = false;
+
+        m_RecordFrame = 0;
+        m_RecordCount = 0;
+    }
+
+    virtual ~FrameCapture()
+    {
+#ifndef EMSCRIPTEN
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Running = false;
+        }
+        m_Condition.notify_one();
+        m_Worker.join();
+
+        if (m_PBO[0] != 0)
+            glDeleteBuffers(2, m_PBO);
+#endif
+    }
+
+    // NOTE : May be called from the scripting threads, the capture happens at the end of the next frame.
+    void screenshot(const char* filename)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Requests.push_back(std::string(filename));
+    }
+
+    // NOTE : Captures the next frames to <prefix>00000.png, <prefix>00001.png, ...
+    void record(const char* prefix, unsigned int frames)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_RecordPrefix = std::string(prefix);
+        m_RecordFrame = 0;
+        m_RecordCount = frames;
+    }
+
+    bool isCapturing()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_Pending || !m_Requests.empty() || m_RecordFrame < m_RecordCount;
+    }
+
+    // NOTE : Must be called after the frame is drawn, with the captured framebuffer bound.
+    void capture(int width, int height)
+    {
+        std::string filename;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (!m_Requests.empty())
+            {
+                filename = m_Requests.front();
+                m_Requests.pop_front();
+            }
+            else if (m_RecordFrame < m_RecordCount)
+            {
+                char suffix[16];
+                sprintf(suffix, "%05u.png", m_RecordFrame++);
+                filename = m_RecordPrefix + suffix;
+            }
+        }
+
+#ifdef EMSCRIPTEN
+        if (!filename.empty())
+        {
+            Image* image = new Image();
+            image->Filename = filename;
+            image->Width = width;
+            image->Height = height;
+            image->Pixels.resize(4 * width * height);
+            glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, image->Pixels.data());
+            push(image);
+        }
+#else
+        // NOTE : The read issued during the previous frame has completed by now
+        if (m_Pending)
+            collect();
+
+        if (filename.empty())
+            return;
+
+        unsigned long size = 4 * width * height;
+        if (m_PBO[0] == 0)
+            glGenBuffers(2, m_PBO);
+        if (size != m_PBOSize)
+        {
+            for (int i = 0; i < 2; i++)
+            {
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, m_PBO[i]);
+                glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+            }
+            m_PBOSize = size;
+        }
+
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, m_PBO[m_Current]);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        m_PendingImage.Filename = filename;
+        m_PendingImage.Width = width;
+        m_PendingImage.Height = height;
+        m_Pending = true;
+#endif
+    }
+
+    // NOTE : Collects the last pending read, even if no frame follows. Needs the GL context.
+    void flush()
+    {
+#ifndef EMSCRIPTEN
+        if (m_Pending)
+            collect();
+#endif
+    }
+
+private:
+#ifndef EMSCRIPTEN
+    void collect()
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, m_PBO[m_Current]);
+        const unsigned char* data = static_cast<const unsigned char*>(glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY));
+
+        if (data != NULL)
+        {
+            Image* image = new Image();
+            image->Filename = m_PendingImage.Filename;
+            image->Width = m_PendingImage.Width;
+            image->Height = m_PendingImage.Height;
+            image->Pixels.assign(data, data + 4 * image->Width * image->Height);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            push(image);
+        }
+        else
+        {
+            LOG("[CAPTURE] Couldn't map pixel buffer for '%s'!\n", m_PendingImage.Filename.c_str());
+        }
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        m_Current = 1 - m_Current;
+        m_Pending = false;
+    }
+#endif
+
+    void push(Image* image)
+    {
+#ifdef EMSCRIPTEN
+        write(image);
+#else
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Images.push_back(image);
+        }
+        m_Condition.notify_one();
+#endif
+    }
+
+    static void write(Image* image)
+    {
+        if (PNG::write(image->Filename, image->Width, image->Height, image->Pixels.data()))
+            LOG("[CAPTURE] Saved '%s' (%ix%i)\n", image->Filename.c_str(), image->Width, image->Height);
+
+        delete image;
+    }
+
+#ifndef EMSCRIPTEN
+    void work()
+    {
+        while (true)
+        {
+            Image* image = NULL;
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_Condition.wait(lock, [this]{ return !m_Images.empty() || !m_Running; });
+
+                if (m_Images.empty())
+                    return;
+
+                image = m_Images.front();
+                m_Images.pop_front();
+            }
+
+            write(image);
+        }
+    }
+
+    std::thread m_Worker;
+    std::condition_variable m_Condition;
+    bool m_Running;
+    std::deque<Image*> m_Images;
+#endif
+
+    std::mutex m_Mutex;
+    std::deque<std::string> m_Requests;
+
+    std::string m_RecordPrefix;
+    unsigned int m_RecordFrame;
+    unsigned int m_RecordCount;
+
+    GLuint m_PBO[2];
+    unsigned long m_PBOSize;
+    int m_Current;
+    bool m_Pending;
+    Image m_PendingImage;
+};
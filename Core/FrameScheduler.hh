@@ -0,0 +1,58 @@
+#pragma once
+
+#include <raindance/Core/Headers.hh>
+
+#include <chrono>
+
+// NOTE : Decouples simulation from the frame rate. Every main loop iteration asks how many fixed steps of
+// simulation are due, layouts then advance at the same pace whether frames are drawn at 30 or 144 Hz.
+// After a stall (event wait, slow frame) at most MaxSubsteps steps are run and the rest of the lag is
+// dropped, so that a slow layout can't snowball into ever longer frames.
+class FrameScheduler
+{
+public:
+    FrameScheduler()
+    {
+        TimeStep = 1.0 / 60.0;
+        MaxSubsteps = 4;
+
+        m_Accumulator = 0.0;
+        m_Started = false;
+    }
+
+    // NOTE : Number of steps to simulate in this iteration, possibly none
+    unsigned int begin()
+    {
+        auto now = std::chrono::steady_clock::now();
+
+        if (!m_Started)
+        {
+            m_Started = true;
+            m_Last = now;
+            return 1;
+        }
+
+        m_Accumulator += std::chrono::duration<double>(now - m_Last).count();
+        m_Last = now;
+
+        unsigned int steps = 0;
+        while (m_Accumulator >= TimeStep && steps < MaxSubsteps)
+        {
+            m_Accumulator -= TimeStep;
+            steps++;
+        }
+
+        if (steps == MaxSubsteps)
+            m_Accumulator = 0.0;
+
+        return steps;
+    }
+
+    double TimeStep; // NOTE : In seconds
+    unsigned int MaxSubsteps;
+
+private:
+    double m_Accumulator;
+    bool m_Started;
+    std::chrono::steady_clock::time_point m_Last;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <raindance/Core/Headers.hh>
+#include <raindance/Core/Scene/NodeVector.hh>
+
+// NOTE : Packs the holes that Scene::NodeVector::remove leaves behind. Views pack their vectors once enough
+// holes have accumulated and remap whatever they index by local ID.
+class NodeCompaction
+{
+public:
+    static const unsigned long Invalid = (unsigned long) -1;
+
+    // NOTE : Fills remap[old ID] with the new ID, or Invalid for holes. Returns the number of nodes left.
+    static unsigned long pack(Scene::NodeVector& nodes, std::vector<unsigned long>& remap)
+    {
+        remap.assign(nodes.size(), Invalid);
+
+        unsigned long count = 0;
+        for (unsigned long i = 0; i < nodes.size(); i++)
+        {
+            if (nodes[i] == NULL)
+                continue;
+
+            nodes[count] = nodes[i];
+            remap[i] = count;
+            count++;
+        }
+
+        nodes.resize(count);
+        return count;
+    }
+
+    // NOTE : Packing costs a pass over the vector and a rebuild of the view structures, it only pays off
+    // once holes outnumber live nodes.
+    static inline bool needed(unsigned long size, unsigned long live)
+    {
+        const unsigned long c_MinHoles = 1024;
+
+        unsigned long holes = size - live;
+        return holes >= c_MinHoles && holes > live;
+    }
+};
+
+// NOTE : Bound to const references by assign/resize, the constant needs storage
+const unsigned long NodeCompaction::Invalid;
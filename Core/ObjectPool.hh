@@ -0,0 +1,129 @@
+#pragma once
+
+#include <raindance/Core/Headers.hh>
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// NOTE : Fixed-size object pool. Memory is carved out of chunks that grow geometrically, so loading a large
+// graph costs a handful of allocations instead of one per element, and released objects are recycled
+// through an intrusive free list in O(1). Chunks are never given back to the system. Pools are not
+// thread-safe, visual elements are only created and destroyed by the main loop.
+template<typename T>
+class ObjectPool
+{
+public:
+    static ObjectPool& getInstance()
+    {
+        // NOTE : Never destroyed, elements owned by static objects may still be released at exit
+        static ObjectPool* s_Instance = new ObjectPool();
+        return *s_Instance;
+    }
+
+    void* allocate(size_t size)
+    {
+        // NOTE : Subclasses don't fit in the slots
+        if (size != sizeof(T))
+            return ::operator new(size);
+
+        if (m_FreeList == NULL)
+            grow(chunk());
+
+        Slot* slot = m_FreeList;
+        m_FreeList = slot->Next;
+        m_Used++;
+        return slot;
+    }
+
+    void release(void* pointer, size_t size)
+    {
+        if (pointer == NULL)
+            return;
+
+        if (size != sizeof(T))
+        {
+            ::operator delete(pointer);
+            return;
+        }
+
+        Slot* slot = static_cast<Slot*>(pointer);
+        slot->Next = m_FreeList;
+        m_FreeList = slot;
+        m_Used--;
+    }
+
+    // NOTE : Makes room for count more objects in a single chunk, small reservations still get a regular one
+    void reserve(unsigned long count)
+    {
+        unsigned long available = m_Capacity - m_Used;
+        if (count <= available)
+            return;
+
+        unsigned long missing = count - available;
+        unsigned long regular = chunk();
+        grow(missing > regular ? missing : regular);
+    }
+
+    inline unsigned long used() const { return m_Used; }
+    inline unsigned long capacity() const { return m_Capacity; }
+
+private:
+    union Slot
+    {
+        Slot* Next;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type Storage;
+    };
+
+    static const unsigned long c_MinChunk = 256;
+    static const unsigned long c_MaxChunk = 65536;
+
+    ObjectPool()
+    {
+        m_FreeList = NULL;
+        m_Capacity = 0;
+        m_Used = 0;
+    }
+
+    // NOTE : Chunks grow geometrically, within bounds
+    unsigned long chunk() const
+    {
+        if (m_Capacity < c_MinChunk)
+            return c_MinChunk;
+        if (m_Capacity > c_MaxChunk)
+            return c_MaxChunk;
+        return m_Capacity;
+    }
+
+    void grow(unsigned long count)
+    {
+        Slot* chunk = static_cast<Slot*>(::operator new(count * sizeof(Slot)));
+        m_Chunks.push_back(chunk);
+
+        // NOTE : Threaded backwards so that the chunk is handed out in address order
+        for (unsigned long i = count; i > 0; i--)
+        {
+            chunk[i - 1].Next = m_FreeList;
+            m_FreeList = &chunk[i - 1];
+        }
+
+        m_Capacity += count;
+    }
+
+    std::vector<Slot*> m_Chunks;
+    Slot* m_FreeList;
+    unsigned long m_Capacity;
+    unsigned long m_Used;
+};
+
+// NOTE : Routes new/delete of T through its pool, T derives from Pooled<T>
+template<typename T>
+class Pooled
+{
+public:
+    static void* operator new(size_t size) { return ObjectPool<T>::getInstance().allocate(size); }
+    static void operator delete(void* pointer, size_t size) { ObjectPool<T>::getInstance().release(pointer, size); }
+
+    static void reserve(unsigned long count) { ObjectPool<T>::getInstance().reserve(count); }
+};
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// NOTE : Minimal RGBA PNG writer. The image data is stored in uncompressed deflate blocks so that
+// no compression library is needed, files are about the size of the raw pixels.
+class PNG
+{
+public:
+    // NOTE : Rows are expected bottom to top, as returned by glReadPixels.
+    static bool write(const std::string& filename, int width, int height, const unsigned char* pixels)
+    {
+        FILE* file = fopen(filename.c_str(), "wb");
+        if (file == NULL)
+        {
+            LOG("[PNG] Couldn't open '%s' for writing!\n", filename.c_str());
+            return false;
+        }
+
+        std::vector<unsigned char> png;
+        encode(width, height, pixels, png);
+
+        bool result = fwrite(png.data(), 1, png.size(), file) == png.size();
+        fclose(file);
+
+        if (!result)
+            LOG("[PNG] Couldn't write '%s'!\n", filename.c_str());
+
+        return result;
+    }
+
+    static void encode(int width, int height, const unsigned char* pixels, std::vector<unsigned char>& png)
+    {
+        static const unsigned char c_Signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        png.assign(c_Signature, c_Signature + 8);
+
+        std::vector<unsigned char> header;
+        put32(header, width);
+        put32(header, height);
+        header.push_back(8); // NOTE : Bit depth
+        header.push_back(6); // NOTE : Color type RGBA
+        header.push_back(0);
+        header.push_back(0);
+        header.push_back(0);
+        chunk(png, "IHDR", header);
+
+        // NOTE : Scanlines are flipped and prefixed with filter type 0
+        unsigned long stride = 4 * width;
+        std::vector<unsigned char> raw;
+        raw.reserve((stride + 1) * height);
+        for (int y = height - 1; y >= 0; y--)
+        {
+            raw.push_back(0);
+            raw.insert(raw.end(), pixels + y * stride, pixels + (y + 1) * stride);
+        }
+
+        std::vector<unsigned char> data;
+        data.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+        data.push_back(0x78);
+        data.push_back(0x01);
+
+        unsigned long offset = 0;
+        do
+        {
+            unsigned long size = std::min<unsigned long>(65535, raw.size() - offset);
+            bool last = offset + size == raw.size();
+
+            data.push_back(last ? 1 : 0);
+            data.push_back(size & 0xFF);
+            data.push_back((size >> 8) & 0xFF);
+            data.push_back(~size & 0xFF);
+            data.push_back((~size >> 8) & 0xFF);
+            data.insert(data.end(), raw.begin() + offset, raw.begin() + offset + size);
+
+            offset += size;
+        } while (offset < raw.size());
+
+        put32(data, adler32(raw.data(), raw.size()));
+        chunk(png, "IDAT", data);
+
+        chunk(png, "IEND", std::vector<unsigned char>());
+    }
+
+private:
+    static void put32(std::vector<unsigned char>& out, unsigned long value)
+    {
+        out.push_back((value >> 24) & 0xFF);
+        out.push_back((value >> 16) & 0xFF);
+        out.push_back((value >> 8) & 0xFF);
+        out.push_back(value & 0xFF);
+    }
+
+    static void chunk(std::vector<unsigned char>& out, const char* type, const std::vector<unsigned char>& data)
+    {
+        put32(out, data.size());
+
+        unsigned long start = out.size();
+        out.insert(out.end(), type, type + 4);
+        out.insert(out.end(), data.begin(), data.end());
+
+        put32(out, crc32(out.data() + start, out.size() - start));
+    }
+
+    static unsigned long crc32(const unsigned char* data, unsigned long size)
+    {
+        static unsigned long table[256];
+        static bool initialized = false;
+
+        if (!initialized)
+        {
+            for (unsigned long n = 0; n < 256; n++)
+            {
+                unsigned long c = n;
+                for (int k = 0; k < 8; k++)
+                    c = c & 1 ? 0xEDB88320UL ^ (c >> 1) : c >> 1;
+                table[n] = c;
+            }
+            initialized = true;
+        }
+
+        unsigned long crc = 0xFFFFFFFFUL;
+        for (unsigned long i = 0; i < size; i++)
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+
+        return crc ^ 0xFFFFFFFFUL;
+    }
+
+    static unsigned long adler32(const unsigned char* data, unsigned long size)
+    {
+        unsigned long a = 1;
+        unsigned long b = 0;
+
+        for (unsigned long i = 0; i < size; i++)
+        {
+            a = (a + data[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+
+        return (b << 16) | a;
+    }
+};
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <raindance/Core/Headers.hh>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// NOTE : Scoped profiling zones, compiled in with -DOG_PROFILE (make profile). Every thread records into its
+// own ring buffer, only the owning thread writes to it so that recording never takes a lock. The last
+// events of every thread can be written as Chrome trace-event JSON, to be opened in chrome://tracing
+// or Perfetto.
+#ifdef OG_PROFILE
+# define OG_PROFILE_CONCAT2(a, b) a##b
+# define OG_PROFILE_CONCAT(a, b) OG_PROFILE_CONCAT2(a, b)
+# define PROFILE_ZONE(name) Profiler::Zone OG_PROFILE_CONCAT(__profile_zone_, __COUNTER__)(name)
+#else
+# define PROFILE_ZONE(name)
+#endif
+
+class Profiler
+{
+public:
+    struct Event
+    {
+        const char* Name; // NOTE : Must be a string literal, only the pointer is kept
+        unsigned long long Start; // NOTE : Microseconds since the profiler was created
+        unsigned long long Duration;
+    };
+
+    // NOTE : Single producer ring buffer, the reader copies it and drops whatever may have been overwritten meanwhile
+    class Buffer
+    {
+    public:
+        static const unsigned long Capacity = 1 << 16;
+
+        Buffer(unsigned int thread) : m_Thread(thread), m_Count(0)
+        {
+            m_Events.resize(Capacity);
+        }
+
+        inline void push(const char* name, unsigned long long start, unsigned long long duration)
+        {
+            unsigned long count = m_Count.load(std::memory_order_relaxed);
+            Event& event = m_Events[count % Capacity];
+            event.Name = name;
+            event.Start = start;
+            event.Duration = duration;
+            m_Count.store(count + 1, std::memory_order_release);
+        }
+
+        void copy(std::vector<Event>& events) const
+        {
+            unsigned long end = m_Count.load(std::memory_order_acquire);
+            unsigned long begin = end > Capacity ? end - Capacity : 0;
+
+            std::vector<Event> copy;
+            copy.reserve(end - begin);
+            for (unsigned long i = begin; i < end; i++)
+                copy.push_back(m_Events[i % Capacity]);
+
+            // NOTE : Events written while copying may have replaced the oldest ones once the free slots were used
+            unsigned long written = m_Count.load(std::memory_order_acquire) - end;
+            unsigned long unused = Capacity - copy.size();
+            unsigned long skip = written > unused ? std::min<unsigned long>(written - unused, copy.size()) : 0;
+            events.insert(events.end(), copy.begin() + skip, copy.end());
+        }
+
+        inline unsigned int thread() const { return m_Thread; }
+
+    private:
+        unsigned int m_Thread;
+        std::vector<Event> m_Events;
+        std::atomic<unsigned long> m_Count;
+    };
+
+    class Zone
+    {
+    public:
+        Zone(const char* name)
+        : m_Name(name), m_Start(Profiler::getInstance().now())
+        {
+        }
+
+        ~Zone()
+        {
+            Profiler& profiler = Profiler::getInstance();
+            profiler.buffer().push(m_Name, m_Start, profiler.now() - m_Start);
+        }
+
+    private:
+        const char* m_Name;
+        unsigned long long m_Start;
+    };
+
+    static Profiler& getInstance()
+    {
+        static Profiler s_Instance;
+        return s_Instance;
+    }
+
+    virtual ~Profiler()
+    {
+        for (auto buffer : m_Buffers)
+            delete buffer;
+    }
+
+    inline unsigned long long now() const
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_Origin).count();
+    }
+
+    // NOTE : The buffer of the calling thread, created on first use. Buffers live as long as the profiler.
+    Buffer& buffer()
+    {
+        static thread_local Buffer* t_Buffer = NULL;
+
+        if (t_Buffer == NULL)
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            t_Buffer = new Buffer(m_Buffers.size() + 1);
+            m_Buffers.push_back(t_Buffer);
+        }
+
+        return *t_Buffer;
+    }
+
+    bool dump(const char* filename)
+    {
+#ifndef OG_PROFILE
+        LOG("[PROFILER] Profiling zones are disabled, rebuild with 'make profile' to record them.\n");
+#endif
+
+        FILE* file = fopen(filename, "w");
+        if (file == NULL)
+        {
+            LOG("[PROFILER] Couldn't open '%s' for writing!\n", filename);
+            return false;
+        }
+
+        std::vector<Buffer*> buffers;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            buffers = m_Buffers;
+        }
+
+        unsigned long count = 0;
+
+        fprintf(file, "{\"traceEvents\":[\n");
+        fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"OpenGraphiti\"}}");
+
+        for (auto buffer : buffers)
+        {
+            fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"Thread %u\"}}",
+                buffer->thread(), buffer->thread());
+
+            std::vector<Event> events;
+            buffer->copy(events);
+
+            for (auto& event : events)
+            {
+                fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"og\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%llu,\"dur\":%llu}",
+                    event.Name, buffer->thread(), event.Start, event.Duration);
+            }
+
+            count += events.size();
+        }
+
+        fprintf(file, "\n]}\n");
+        fclose(file);
+
+        LOG("[PROFILER] %lu events from %lu threads written to '%s'\n", count, (unsigned long) buffers.size(), filename);
+        return true;
+    }
+
+private:
+    Profiler()
+    : m_Origin(std::chrono::steady_clock::now())
+    {
+    }
+
+    std::chrono::steady_clock::time_point m_Origin;
+    std::mutex m_Mutex;
+    std::vector<Buffer*> m_Buffers;
+};
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <raindance/Core/Headers.hh>
+
+#include <cmath>
+#include <map>
+
+// NOTE : Shadow copy of the GL state set by the Graphiti render path. Calls that wouldn't change anything
+// are filtered out and counted. The engine changes state behind our back (HUD, icons, text, widgets), so the
+// shadow must be invalidated after every engine draw, and unknown values always go through.
+class RenderState
+{
+public:
+    struct Counters
+    {
+        Counters() : Changes(0), Avoided(0) {}
+
+        unsigned long Changes;
+        unsigned long Avoided;
+    };
+
+    static RenderState& getInstance()
+    {
+        static RenderState s_Instance;
+        return s_Instance;
+    }
+
+    void beginFrame()
+    {
+        m_LastFrame = m_Frame;
+        m_Frame = Counters();
+        invalidate();
+    }
+
+    void invalidate()
+    {
+        m_Capabilities.clear();
+        m_BlendFunc[0] = m_BlendFunc[1] = GL_INVALID_ENUM;
+        m_LineWidth = -1.0f;
+        m_PolygonOffset[0] = m_PolygonOffset[1] = NAN;
+        m_Program = 0;
+    }
+
+    inline void enable(GLenum capability) { setCapability(capability, true); }
+    inline void disable(GLenum capability) { setCapability(capability, false); }
+
+    void blendFunc(GLenum source, GLenum destination)
+    {
+        if (m_BlendFunc[0] == source && m_BlendFunc[1] == destination)
+        {
+            m_Frame.Avoided++;
+            return;
+        }
+
+        glBlendFunc(source, destination);
+        m_BlendFunc[0] = source;
+        m_BlendFunc[1] = destination;
+        m_Frame.Changes++;
+    }
+
+    void lineWidth(float width)
+    {
+        if (m_LineWidth == width)
+        {
+            m_Frame.Avoided++;
+            return;
+        }
+
+        glLineWidth(width);
+        m_LineWidth = width;
+        m_Frame.Changes++;
+    }
+
+    void polygonOffset(float factor, float units)
+    {
+        if (m_PolygonOffset[0] == factor && m_PolygonOffset[1] == units)
+        {
+            m_Frame.Avoided++;
+            return;
+        }
+
+        glPolygonOffset(factor, units);
+        m_PolygonOffset[0] = factor;
+        m_PolygonOffset[1] = units;
+        m_Frame.Changes++;
+    }
+
+    // NOTE : The GL name of a program is only queried the first time it is used
+    void use(Shader::Program* program)
+    {
+        auto it = m_Programs.find(program);
+        if (it != m_Programs.end() && m_Program != 0 && it->second == m_Program)
+        {
+            m_Frame.Avoided++;
+            return;
+        }
+
+        program->use();
+        m_Frame.Changes++;
+
+        if (it == m_Programs.end())
+        {
+            GLint current = 0;
+            glGetIntegerv(GL_CURRENT_PROGRAM, &current);
+            it = m_Programs.insert(std::make_pair(program, static_cast<GLuint>(current))).first;
+        }
+
+        m_Program = it->second;
+    }
+
+    // NOTE : Program in use, 0 when unknown
+    inline GLuint program() const { return m_Program; }
+
+    inline const Counters& frame() const { return m_Frame; }
+    inline const Counters& lastFrame() const { return m_LastFrame; }
+
+private:
+    RenderState()
+    {
+        invalidate();
+    }
+
+    void setCapability(GLenum capability, bool enabled)
+    {
+        auto it = m_Capabilities.find(capability);
+        if (it != m_Capabilities.end() && it->second == enabled)
+        {
+            m_Frame.Avoided++;
+            return;
+        }
+
+        if (enabled)
+            glEnable(capability);
+        else
+            glDisable(capability);
+
+        m_Capabilities[capability] = enabled;
+        m_Frame.Changes++;
+    }
+
+    std::map<GLenum, bool> m_Capabilities;
+    GLenum m_BlendFunc[2];
+    float m_LineWidth;
+    float m_PolygonOffset[2];
+    std::map<Shader::Program*, GLuint> m_Programs;
+    GLuint m_Program;
+
+    Counters m_Frame;
+    Counters m_LastFrame;
+};
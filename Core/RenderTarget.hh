@@ -0,0 +1,124 @@
+#pragma once
+
+#include <raindance/Core/Headers.hh>
+
+// NOTE : Offscreen framebuffer with a color texture and a depth renderbuffer.
+// Binding saves the current framebuffer and viewport, unbinding restores them.
+// Float targets need a sized internal format on desktop GL (Ex: GL_RGBA16F) and GL_RGBA on WebGL.
+class RenderTarget
+{
+public:
+    RenderTarget(GLint internalFormat = GL_RGBA, GLenum type = GL_UNSIGNED_BYTE)
+    : m_InternalFormat(internalFormat), m_Type(type)
+    {
+        m_Width = 0;
+        m_Height = 0;
+        m_Framebuffer = 0;
+        m_ColorTexture = 0;
+        m_DepthBuffer = 0;
+        m_PreviousFramebuffer = 0;
+    }
+
+    virtual ~RenderTarget()
+    {
+        destroy();
+    }
+
+    bool resize(int width, int height)
+    {
+        if (width == m_Width && height == m_Height && m_Framebuffer != 0)
+            return true;
+
+        destroy();
+
+        m_Width = width;
+        m_Height = height;
+
+        glGenTextures(1, &m_ColorTexture);
+        glBindTexture(GL_TEXTURE_2D, m_ColorTexture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, m_InternalFormat, width, height, 0, GL_RGBA, m_Type, NULL);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glGenRenderbuffers(1, &m_DepthBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, m_DepthBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        GLint previous = 0;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
+
+        glGenFramebuffers(1, &m_Framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_Framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_ColorTexture, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_DepthBuffer);
+
+        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        glBindFramebuffer(GL_FRAMEBUFFER, previous);
+
+        if (status != GL_FRAMEBUFFER_COMPLETE)
+        {
+            LOG("[RENDERTARGET] Incomplete framebuffer (%ix%i, status 0x%x)!\n", width, height, status);
+            destroy();
+            return false;
+        }
+
+        return true;
+    }
+
+    void bind()
+    {
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &m_PreviousFramebuffer);
+        glGetIntegerv(GL_VIEWPORT, m_PreviousViewport);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, m_Framebuffer);
+        glViewport(0, 0, m_Width, m_Height);
+    }
+
+    void unbind()
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_PreviousFramebuffer);
+        glViewport(m_PreviousViewport[0], m_PreviousViewport[1], m_PreviousViewport[2], m_PreviousViewport[3]);
+    }
+
+    // NOTE : The target must be bound
+    inline void read(int x, int y, int width, int height, void* data)
+    {
+        glReadPixels(x, y, width, height, GL_RGBA, m_Type, data);
+    }
+
+    inline bool isValid() const { return m_Framebuffer != 0; }
+    inline int getWidth() const { return m_Width; }
+    inline int getHeight() const { return m_Height; }
+    inline GLuint getColorTexture() const { return m_ColorTexture; }
+
+private:
+    void destroy()
+    {
+        if (m_Framebuffer != 0)
+            glDeleteFramebuffers(1, &m_Framebuffer);
+        if (m_ColorTexture != 0)
+            glDeleteTextures(1, &m_ColorTexture);
+        if (m_DepthBuffer != 0)
+            glDeleteRenderbuffers(1, &m_DepthBuffer);
+
+        m_Framebuffer = 0;
+        m_ColorTexture = 0;
+        m_DepthBuffer = 0;
+    }
+
+    GLint m_InternalFormat;
+    GLenum m_Type;
+    int m_Width;
+    int m_Height;
+
+    GLuint m_Framebuffer;
+    GLuint m_ColorTexture;
+    GLuint m_DepthBuffer;
+
+    GLint m_PreviousFramebuffer;
+    GLint m_PreviousViewport[4];
+};
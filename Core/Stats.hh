@@ -0,0 +1,273 @@
+#pragma once
+
+#include <raindance/Core/Headers.hh>
+
+#include <chrono>
+#include <mutex>
+#include <sstream>
+
+// NOTE : Timer queries need OpenGL 3.3 or ARB_timer_query, WebGL has none.
+#if !defined(EMSCRIPTEN) && defined(GL_TIME_ELAPSED)
+# define OG_TIMER_QUERY
+#endif
+
+// NOTE : Per-frame performance counters. CPU sections are timed with scoped timers, the GPU time of the
+// frame with timer queries read back a few frames later so that the pipeline never stalls. A frame
+// spans everything between two ends of GLWindow::draw, idle loops included. Averages are exponentially
+// smoothed so that the overlay stays readable.
+class Stats
+{
+public:
+    enum Section
+    {
+        IDLE,     // NOTE : Whole main loop iteration, without the time spent waiting for events
+        SIMULATION, // NOTE : Fixed steps of the frame scheduler, layout and octree included
+        LAYOUT,
+        OCTREE,
+        DRAW,
+        MESSAGES,
+        SECTION_COUNT
+    };
+
+    struct Frame
+    {
+        Frame()
+        {
+            for (unsigned int i = 0; i < SECTION_COUNT; i++)
+                CPU[i] = 0.0;
+            GPU = 0.0;
+            Interval = 0.0;
+            DrawCalls = 0;
+            Primitives = 0;
+            Visible = 0;
+            Culled = 0;
+            Substeps = 0;
+        }
+
+        double CPU[SECTION_COUNT]; // NOTE : Milliseconds
+        double GPU;
+        double Interval;
+        unsigned long DrawCalls;
+        unsigned long Primitives;
+        unsigned long Visible;
+        unsigned long Culled;
+        unsigned long Substeps;
+    };
+
+    class Timer
+    {
+    public:
+        Timer(Section section)
+        : m_Section(section), m_Start(std::chrono::steady_clock::now())
+        {
+        }
+
+        ~Timer()
+        {
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - m_Start;
+            Stats::getInstance().add(m_Section, elapsed.count());
+        }
+
+    private:
+        Section m_Section;
+        std::chrono::steady_clock::time_point m_Start;
+    };
+
+    static Stats& getInstance()
+    {
+        static Stats s_Instance;
+        return s_Instance;
+    }
+
+    virtual ~Stats()
+    {
+#ifdef OG_TIMER_QUERY
+        if (m_Queries[0] != 0)
+            glDeleteQueries(c_QueryCount, m_Queries);
+#endif
+    }
+
+    inline void add(Section section, double milliseconds) { m_Frame.CPU[section] += milliseconds; }
+
+    inline void drawCall(unsigned long primitives)
+    {
+        m_Frame.DrawCalls++;
+        m_Frame.Primitives += primitives;
+    }
+
+    inline void visible(unsigned long count) { m_Frame.Visible += count; }
+    inline void culled(unsigned long count) { m_Frame.Culled += count; }
+    inline void substeps(unsigned long count) { m_Frame.Substeps += count; }
+
+    // NOTE : Brackets the GPU work of a frame. Only one query can be active at a time, drawing code must not issue its own.
+    void beginGPU()
+    {
+#ifdef OG_TIMER_QUERY
+        if (m_Queries[0] == 0)
+            glGenQueries(c_QueryCount, m_Queries);
+
+        // NOTE : Results are collected oldest first, a query still in flight is skipped for this frame
+        for (unsigned int i = 0; i < c_QueryCount; i++)
+        {
+            unsigned int index = (m_Query + i) % c_QueryCount;
+            if (!m_QueryIssued[index])
+                continue;
+
+            GLint available = 0;
+            glGetQueryObjectiv(m_Queries[index], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available)
+                continue;
+
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(m_Queries[index], GL_QUERY_RESULT, &nanoseconds);
+            m_Frame.GPU = nanoseconds / 1000000.0;
+            m_QueryIssued[index] = false;
+        }
+
+        if (m_QueryIssued[m_Query])
+            return;
+
+        glBeginQuery(GL_TIME_ELAPSED, m_Queries[m_Query]);
+        m_QueryActive = true;
+#endif
+    }
+
+    void endGPU()
+    {
+#ifdef OG_TIMER_QUERY
+        if (!m_QueryActive)
+            return;
+
+        glEndQuery(GL_TIME_ELAPSED);
+        m_QueryIssued[m_Query] = true;
+        m_QueryActive = false;
+        m_Query = (m_Query + 1) % c_QueryCount;
+#endif
+    }
+
+    void endFrame()
+    {
+        const double c_Smoothing = 0.1;
+
+        auto now = std::chrono::steady_clock::now();
+        if (m_FrameCount > 0)
+            m_Frame.Interval = std::chrono::duration<double, std::milli>(now - m_FrameEnd).count();
+        m_FrameEnd = now;
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        if (m_FrameCount == 0)
+            m_Average = m_Frame;
+        else
+        {
+            for (unsigned int i = 0; i < SECTION_COUNT; i++)
+                m_Average.CPU[i] += c_Smoothing * (m_Frame.CPU[i] - m_Average.CPU[i]);
+            m_Average.GPU += c_Smoothing * (m_Frame.GPU - m_Average.GPU);
+            m_Average.Interval += c_Smoothing * (m_Frame.Interval - m_Average.Interval);
+        }
+
+        // NOTE : GPU times arrive late, the last known value is carried over frames without a result
+        double gpu = m_Frame.GPU;
+
+        m_Last = m_Frame;
+        m_Frame = Frame();
+        m_Frame.GPU = gpu;
+        m_FrameCount++;
+    }
+
+    // NOTE : Smoothed times, counters of the last frame. May be called from the scripting threads.
+    std::string report()
+    {
+        static const char* c_Names[SECTION_COUNT] = { "idle", "simulation", "layout", "octree", "draw", "messages" };
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        std::stringstream ss;
+        ss.precision(3);
+        ss << std::fixed;
+        ss << "{\"frame\": " << m_FrameCount;
+        ss << ", \"fps\": " << (m_Average.Interval > 0.0 ? 1000.0 / m_Average.Interval : 0.0);
+        ss << ", \"cpu\": {";
+        for (unsigned int i = 0; i < SECTION_COUNT; i++)
+            ss << (i > 0 ? ", " : "") << "\"" << c_Names[i] << "\": " << m_Average.CPU[i];
+        ss << "}";
+        ss << ", \"gpu\": " << m_Average.GPU;
+        ss << ", \"draw_calls\": " << m_Last.DrawCalls;
+        ss << ", \"primitives\": " << m_Last.Primitives;
+        ss << ", \"visible\": " << m_Last.Visible;
+        ss << ", \"culled\": " << m_Last.Culled;
+        ss << ", \"substeps\": " << m_Last.Substeps;
+        ss << "}";
+        return ss.str();
+    }
+
+    // NOTE : Overlay text, one entry per line
+    void lines(std::vector<std::string>& output)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        char line[128];
+        output.clear();
+
+        sprintf(line, "%.1f fps (%.2f ms)", m_Average.Interval > 0.0 ? 1000.0 / m_Average.Interval : 0.0, m_Average.Interval);
+        output.push_back(line);
+        sprintf(line, "CPU idle %.2f ms, simulation %.2f ms (%lu steps)", m_Average.CPU[IDLE], m_Average.CPU[SIMULATION], m_Last.Substeps);
+        output.push_back(line);
+        sprintf(line, "CPU layout %.2f ms, octree %.2f ms", m_Average.CPU[LAYOUT], m_Average.CPU[OCTREE]);
+        output.push_back(line);
+        sprintf(line, "CPU draw %.2f ms, messages %.2f ms", m_Average.CPU[DRAW], m_Average.CPU[MESSAGES]);
+        output.push_back(line);
+#ifdef OG_TIMER_QUERY
+        sprintf(line, "GPU %.2f ms", m_Average.GPU);
+#else
+        sprintf(line, "GPU n/a");
+#endif
+        output.push_back(line);
+        sprintf(line, "%lu draw calls, %lu primitives", m_Last.DrawCalls, m_Last.Primitives);
+        output.push_back(line);
+        sprintf(line, "%lu visible, %lu culled", m_Last.Visible, m_Last.Culled);
+        output.push_back(line);
+    }
+
+    void dump()
+    {
+        LOG("[STATS] %s\n", report().c_str());
+    }
+
+    inline const Frame& last() const { return m_Last; }
+
+    bool Overlay;
+
+private:
+    Stats()
+    {
+        Overlay = false;
+        m_FrameCount = 0;
+
+#ifdef OG_TIMER_QUERY
+        for (unsigned int i = 0; i < c_QueryCount; i++)
+        {
+            m_Queries[i] = 0;
+            m_QueryIssued[i] = false;
+        }
+        m_Query = 0;
+        m_QueryActive = false;
+#endif
+    }
+
+    std::mutex m_Mutex;
+
+    Frame m_Frame;
+    Frame m_Last;
+    Frame m_Average;
+    unsigned long m_FrameCount;
+    std::chrono::steady_clock::time_point m_FrameEnd;
+
+#ifdef OG_TIMER_QUERY
+    static const unsigned int c_QueryCount = 4;
+    GLuint m_Queries[c_QueryCount];
+    bool m_QueryIssued[c_QueryCount];
+    unsigned int m_Query;
+    bool m_QueryActive;
+#endif
+};
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <raindance/Core/Headers.hh>
+#include <raindance/Core/Light.hh>
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include "Core/RenderState.hh"
+
+// NOTE : Values shared by every program drawn in a frame: camera and light. GLSL 1.x and WebGL have no uniform
+// buffer objects, so the block is uploaded at most once per program every time it changes instead.
+class FrameUniforms
+{
+public:
+    FrameUniforms()
+    {
+        m_Version = 0;
+    }
+
+    void update(const glm::mat4& view, const glm::mat4& projection, const Light& light = Light())
+    {
+        View = view;
+        Projection = projection;
+        Eye = glm::vec3(glm::inverse(view)[3]);
+        Sun = light;
+        m_Version = nextVersion();
+    }
+
+    inline unsigned long version() const { return m_Version; }
+
+    glm::mat4 View;
+    glm::mat4 Projection;
+    glm::vec3 Eye;
+    Light Sun;
+
+private:
+    // NOTE : Versions are unique across blocks so that a program drawn by two views is refreshed when switching
+    static unsigned long nextVersion()
+    {
+        static unsigned long s_Version = 0;
+        return ++s_Version;
+    }
+
+    unsigned long m_Version;
+};
+
+// NOTE : Uniform locations of one program, resolved once instead of being looked up by name on every draw.
+// The last uploaded values are kept so that redundant uploads are skipped, every upload of a cached
+// uniform must go through this cache. There must be a single cache per program.
+class UniformCache
+{
+public:
+    typedef unsigned int Handle;
+
+    UniformCache()
+    {
+        m_Program = 0;
+        m_FrameVersion = 0;
+
+        m_View = declare("u_ViewMatrix");
+        m_Projection = declare("u_ProjectionMatrix");
+        m_Eye = declare("u_CameraPosition");
+        m_LightType = declare("u_Light.Type");
+        m_LightPosition = declare("u_Light.Position");
+        m_LightDirection = declare("u_Light.Direction");
+        m_LightColor = declare("u_Light.Color");
+    }
+
+    virtual ~UniformCache()
+    {
+    }
+
+    // NOTE : Declaring the same name twice returns the same handle
+    Handle declare(const char* name)
+    {
+        for (Handle handle = 0; handle < m_Uniforms.size(); handle++)
+            if (m_Uniforms[handle].Name == name)
+                return handle;
+
+        Uniform uniform;
+        uniform.Name = std::string(name);
+        uniform.Location = -1;
+        uniform.Size = 0;
+        m_Uniforms.push_back(uniform);
+
+        m_Program = 0;
+        return m_Uniforms.size() - 1;
+    }
+
+    // NOTE : Must be called after the program is put in use through RenderState::use. Locations are only
+    // queried the first time.
+    void bind()
+    {
+        GLuint program = RenderState::getInstance().program();
+        if (program == 0)
+        {
+            GLint current = 0;
+            glGetIntegerv(GL_CURRENT_PROGRAM, &current);
+            program = static_cast<GLuint>(current);
+        }
+
+        if (program == m_Program)
+            return;
+
+        for (auto& uniform : m_Uniforms)
+        {
+            uniform.Location = glGetUniformLocation(program, uniform.Name.c_str());
+            uniform.Size = 0;
+        }
+
+        m_Program = program;
+        m_FrameVersion = 0;
+    }
+
+    void set(const FrameUniforms& frame)
+    {
+        if (frame.version() == m_FrameVersion)
+            return;
+
+        set(m_View, frame.View);
+        set(m_Projection, frame.Projection);
+        set(m_Eye, frame.Eye);
+        set(m_LightType, (int) frame.Sun.getType());
+        set(m_LightPosition, frame.Sun.getPosition());
+        set(m_LightDirection, frame.Sun.getDirection());
+        set(m_LightColor, frame.Sun.getColor());
+
+        m_FrameVersion = frame.version();
+    }
+
+    inline void set(Handle handle, int value)
+    {
+        float v = (float) value;
+        if (changed(handle, &v, 1))
+            glUniform1i(m_Uniforms[handle].Location, value);
+    }
+
+    inline void set(Handle handle, float value)
+    {
+        if (changed(handle, &value, 1))
+            glUniform1f(m_Uniforms[handle].Location, value);
+    }
+
+    inline void set(Handle handle, const glm::vec2& value)
+    {
+        if (changed(handle, glm::value_ptr(value), 2))
+            glUniform2fv(m_Uniforms[handle].Location, 1, glm::value_ptr(value));
+    }
+
+    inline void set(Handle handle, const glm::vec3& value)
+    {
+        if (changed(handle, glm::value_ptr(value), 3))
+            glUniform3fv(m_Uniforms[handle].Location, 1, glm::value_ptr(value));
+    }
+
+    inline void set(Handle handle, const glm::vec4& value)
+    {
+        if (changed(handle, glm::value_ptr(value), 4))
+            glUniform4fv(m_Uniforms[handle].Location, 1, glm::value_ptr(value));
+    }
+
+    inline void set(Handle handle, const glm::mat3& value)
+    {
+        if (changed(handle, glm::value_ptr(value), 9))
+            glUniformMatrix3fv(m_Uniforms[handle].Location, 1, GL_FALSE, glm::value_ptr(value));
+    }
+
+    inline void set(Handle handle, const glm::mat4& value)
+    {
+        if (changed(handle, glm::value_ptr(value), 16))
+            glUniformMatrix4fv(m_Uniforms[handle].Location, 1, GL_FALSE, glm::value_ptr(value));
+    }
+
+    // NOTE : Samplers. The texture is bound to its unit, the sampler is only uploaded when the unit changes.
+    inline void set(Handle handle, GLuint texture, int unit)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        set(handle, unit);
+    }
+
+    // NOTE : The next upload goes through, for values the engine may have set behind the cache
+    inline void forget(Handle handle) { m_Uniforms[handle].Size = 0; }
+
+private:
+    struct Uniform
+    {
+        std::string Name;
+        GLint Location;
+        unsigned int Size; // NOTE : 0 until a value has been uploaded
+        float Value[16];
+    };
+
+    inline bool changed(Handle handle, const float* value, unsigned int size)
+    {
+        Uniform& uniform = m_Uniforms[handle];
+        if (uniform.Location < 0)
+            return false;
+
+        if (uniform.Size == size && memcmp(uniform.Value, value, size * sizeof(float)) == 0)
+            return false;
+
+        memcpy(uniform.Value, value, size * sizeof(float));
+        uniform.Size = size;
+        return true;
+    }
+
+    std::vector<Uniform> m_Uniforms;
+    GLuint m_Program;
+    unsigned long m_FrameVersion;
+
+    Handle m_View;
+    Handle m_Projection;
+    Handle m_Eye;
+    Handle m_LightType;
+    Handle m_LightPosition;
+    Handle m_LightDirection;
+    Handle m_LightColor;
+};
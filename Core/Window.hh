@@ -2,55 +2,186 @@
 
 #include <raindance/Core/GUI/Window.hh>
 #include <raindance/Core/GUI/HUD.hh>
+#include <raindance/Core/Text.hh>
+#include <raindance/Core/Transformation.hh>
 
 #include <graphiti/Entities/MVC.hh>
 
+#include "Core/RenderTarget.hh"
+#include "Core/RenderState.hh"
+#include "Core/FrameCapture.hh"
+#include "Core/Stats.hh"
+#include "Core/Profiler.hh"
+
 class GLWindow : public Window
 {
 public:
-    GLWindow(const char* title, const int width, const int height, Root* parent = NULL)
+    // NOTE : Offscreen windows are hidden and draw into a render target of the requested size, the default
+    // framebuffer of a hidden window isn't guaranteed to hold any pixel.
+    GLWindow(const char* title, const int width, const int height, Root* parent = NULL, bool offscreen = false)
     : Window(title, width, height)
     {
         m_ActiveVisualizer = 0;
+        m_Invalidated = true;
+        m_Drawn = false;
+        m_Offscreen = offscreen;
+        m_Width = width;
+        m_Height = height;
 
         m_HUD = new HUD(getViewport());
         m_HUD->bind(parent->context());
 
+        m_StatsFont = NULL;
+
         m_Parent = parent;
     }
 
     virtual ~GLWindow()
     {
+        // NOTE : The context is still alive here, the read issued for the last captured frame can be mapped
+        m_Capture.flush();
+
         SAFE_DELETE(m_HUD);
+
+        for (auto text : m_StatsText)
+            delete text;
+        SAFE_DELETE(m_StatsFont);
     }
 
     virtual void draw(Context* context)
     {
-        auto visualizer = getActiveVisualizer();
-        if (visualizer)
+        PROFILE_ZONE("GLWindow::draw");
+
+        // NOTE : Nothing is stale, the previous frame stays on screen and the buffers aren't swapped
+        m_Drawn = needsRedraw();
+        if (!m_Drawn)
+            return;
+
+        // NOTE : Checked before the GPU timer starts, a frame that isn't drawn must not leave a query open
+        if (m_Offscreen && !m_RenderTarget.resize(m_Width, m_Height))
+        {
+            m_Drawn = false;
+            return;
+        }
+
+        RenderState::getInstance().beginFrame();
+        Stats::getInstance().beginGPU();
+
+        if (m_Offscreen)
+        {
+            m_RenderTarget.bind();
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        }
+
+        {
+            Stats::Timer timer(Stats::DRAW);
+
+            auto visualizer = getActiveVisualizer();
+            if (visualizer)
+            {
+                if (visualizer->view() != NULL)
+                    visualizer->view()->draw();
+                if (visualizer->controller() != NULL)
+                    visualizer->controller()->draw();
+
+                // NOTE : Controllers draw their widgets through the engine
+                RenderState::getInstance().invalidate();
+            }
+
+            if (!m_Offscreen)
+            {
+                m_HUD->draw(context);
+                RenderState::getInstance().invalidate();
+            }
+        }
+
+        if (!m_Offscreen && Stats::getInstance().Overlay)
+            drawStats(context);
+
+        Stats::getInstance().endGPU();
+
+        if (m_Offscreen)
+        {
+            m_Capture.capture(m_Width, m_Height);
+            m_RenderTarget.unbind();
+        }
+        else
+        {
+            glm::vec2 dimension = getViewport().getDimension();
+            m_Capture.capture((int) dimension[0], (int) dimension[1]);
+        }
+
+        Stats::getInstance().endFrame();
+
+        m_Invalidated = false;
+    }
+
+    void postDraw() override
+    {
+        if (m_Drawn)
+            Window::postDraw();
+    }
+
+    // NOTE : Shows the stats of the previous frame in the top left corner, one text per line.
+    void drawStats(Context* context)
+    {
+        const float c_LineHeight = 14.0f;
+        const float c_Margin = 10.0f;
+
+        if (m_StatsFont == NULL)
+            m_StatsFont = new Font();
+
+        std::vector<std::string> lines;
+        Stats::getInstance().lines(lines);
+
+        while (m_StatsText.size() < lines.size())
+            m_StatsText.push_back(new Text());
+
+        glm::vec2 dimension = getViewport().getDimension();
+        glm::mat4 projection = glm::ortho(0.0f, dimension[0], 0.0f, dimension[1]);
+
+        float scale = c_LineHeight / (m_StatsFont->getSize() * m_StatsFont->getHeight());
+
+        RenderState::getInstance().disable(GL_DEPTH_TEST);
+        RenderState::getInstance().enable(GL_BLEND);
+        RenderState::getInstance().blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        for (unsigned int i = 0; i < lines.size(); i++)
         {
-            if (visualizer->view() != NULL)
-                visualizer->view()->draw();
-            if (visualizer->controller() != NULL)
-                visualizer->controller()->draw();
+            m_StatsText[i]->set(lines[i].c_str(), m_StatsFont);
+            m_StatsText[i]->setColor(glm::vec4(1.0, 1.0, 1.0, 1.0));
+
+            Transformation transformation;
+            transformation.translate(glm::vec3(c_Margin, dimension[1] - c_Margin - (i + 1) * c_LineHeight, 0.0));
+            transformation.scale(glm::vec3(scale, scale, 1.0));
+            m_StatsText[i]->draw(context, projection * transformation.state());
         }
 
-        m_HUD->draw(context);
+        RenderState::getInstance().invalidate();
     }
 
+    // NOTE : Window events always invalidate the frame, the active visualizer decides for everything else.
+    bool needsRedraw()
+    {
+        if (m_Invalidated || m_Capture.isCapturing())
+            return true;
+
+        auto visualizer = getActiveVisualizer();
+        if (visualizer == NULL)
+            return false;
+
+        return (visualizer->view() != NULL && visualizer->view()->needsRedraw())
+            || (visualizer->controller() != NULL && visualizer->controller()->needsRedraw());
+    }
+
+    inline void invalidate() { m_Invalidated = true; }
+
     virtual void idle(Context* context)
     {
         (void) context;
         
+        // NOTE : Views and controllers are stepped by Graphiti's frame scheduler
         m_HUD->idle();
-
-        for (auto visualizer : m_Visualizers)
-        {
-            if (visualizer->view() != NULL)
-                visualizer->view()->idle();
-            if (visualizer->controller() != NULL)
-                visualizer->controller()->idle();
-        }
     }
 
      // ----- TODO : VisualizerManager -----
@@ -58,6 +189,10 @@ public:
     inline void addVisualizer(EntityVisualizer* visualizer)
     {
         m_Visualizers.push_back(visualizer);
+
+        // NOTE : Only the active visualizer follows the entity live
+        if (m_Visualizers.size() > 1)
+            visualizer->setActive(false);
     }
 
     inline EntityVisualizer* getActiveVisualizer()
@@ -69,14 +204,20 @@ public:
 
     inline void selectNextVisualizer()
     {
-        if (!m_Visualizers.empty())
-            m_ActiveVisualizer = (m_ActiveVisualizer + 1) % m_Visualizers.size();
+        if (m_Visualizers.empty())
+            return;
+
+        m_Visualizers[m_ActiveVisualizer]->setActive(false);
+        m_ActiveVisualizer = (m_ActiveVisualizer + 1) % m_Visualizers.size();
+        m_Visualizers[m_ActiveVisualizer]->setActive(true);
     }
 
     // ----- Window Events -----
 
     void onWindowSize(int width, int height) override
     {
+        invalidate();
+
         m_HUD->reshape(getViewport());
 
         for (auto visualizer : m_Visualizers)
@@ -86,6 +227,8 @@ public:
 
     void onSetFramebufferSize(int width, int height) override
     {
+        invalidate();
+
         glViewport(0, 0, width, height);
 
         m_HUD->reshape(getViewport());
@@ -97,6 +240,8 @@ public:
 
     void onCursorPos(double xpos, double ypos) override
     {
+        invalidate();
+
         m_HUD->onCursorPos(xpos, ypos);
 
         auto visualizer = getActiveVisualizer();
@@ -106,6 +251,8 @@ public:
 
     void onMouseButton(int button, int action, int mods) override
     {
+        invalidate();
+
         m_HUD->onMouseButton(button, action, mods);
 
         if (m_HUD->getWidgetPick() == NULL)
@@ -118,6 +265,8 @@ public:
 
     void onKey(int key, int scancode, int action, int mods) override
     {     
+        invalidate();
+
          m_HUD->onKey(key, scancode, action, mods);
            
         if (key == GLFW_KEY_N && action == 1 /* DOWN */)
@@ -127,7 +276,14 @@ public:
             Geometry::getMetrics().dump();
             Geometry::getMetrics().reset();
             ResourceManager::getInstance().dump();
+
+            const RenderState::Counters& counters = RenderState::getInstance().lastFrame();
+            LOG("[RENDERSTATE] Last frame : %lu state changes, %lu redundant changes avoided\n", counters.Changes, counters.Avoided);
+
+            Stats::getInstance().dump();
         }
+        else if (key == GLFW_KEY_F3 && action == 1 /* DOWN */)
+            Stats::getInstance().Overlay = !Stats::getInstance().Overlay;
         else
         {
             auto visualizer = getActiveVisualizer();
@@ -138,12 +294,16 @@ public:
 
     void onScroll(double xoffset, double yoffset) override
     {
+        invalidate();
+
         auto visualizer = getActiveVisualizer();
         if (visualizer)
             visualizer->controller()->onScroll(xoffset, yoffset);
     }
 
     inline HUD* hud() { return m_HUD; }
+    inline FrameCapture& capture() { return m_Capture; }
+    inline bool isOffscreen() const { return m_Offscreen; }
 
     inline Root* getParent() { return m_Parent; }
 
@@ -152,4 +312,15 @@ private:
     std::vector<EntityVisualizer*> m_Visualizers;
     int m_ActiveVisualizer;
     HUD* m_HUD;
+    bool m_Invalidated;
+    bool m_Drawn;
+
+    bool m_Offscreen;
+    int m_Width;
+    int m_Height;
+    RenderTarget m_RenderTarget;
+    FrameCapture m_Capture;
+
+    Font* m_StatsFont;
+    std::vector<Text*> m_StatsText;
 };
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <raindance/Core/Headers.hh>
+#include <raindance/Core/Sequencer/Sequencer.hh>
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+// NOTE : Batched graph command, as encoded by send_commands. Types are parsed and names interned when encoding.
+struct GraphCommandRecord
+{
+    enum Kind
+    {
+        SET_ATTRIBUTE,
+        ADD_NODE,
+        REMOVE_NODE,
+        SET_NODE_ATTRIBUTE,
+        ADD_LINK,
+        REMOVE_LINK,
+        SET_LINK_ATTRIBUTE
+    };
+
+    Timecode Time;
+    unsigned char Kind;
+    unsigned char Type;         // NOTE : VariableType of attribute values
+    const std::string* Name;    // NOTE : Interned attribute name
+    unsigned long ID1;          // NOTE : Node or link ID, source node of new links
+    unsigned long ID2;          // NOTE : Target node of new links
+    unsigned long Text;         // NOTE : Offset of the label or value in the text buffer
+};
+
+// NOTE : Storage of the records sent to a command track. Records of every batch are packed one after the other
+// in fixed-size chunks, the command blocks playing them only hold a range of a chunk. A chunk is released
+// along with the last block referencing it, once the arena moved on to the next one.
+//
+// Batches may be sent from the scripting threads while the main loop plays earlier blocks. Appending is
+// serialized by the arena lock, and chunks never grow, so the records and text a block reads never move.
+class GraphCommandArena
+{
+public:
+    class Chunk
+    {
+    public:
+        Chunk(unsigned long records, unsigned long text)
+        : m_References(1)
+        {
+            m_Records = new GraphCommandRecord[records];
+            m_RecordCount = 0;
+            m_RecordCapacity = records;
+
+            // NOTE : Offset 0 is the empty string, for records without text
+            m_Text = new char[text];
+            m_Text[0] = '\0';
+            m_TextSize = 1;
+            m_TextCapacity = text;
+        }
+
+        ~Chunk()
+        {
+            delete[] m_Records;
+            delete[] m_Text;
+        }
+
+        inline bool fits(unsigned long length) const
+        {
+            return m_RecordCount < m_RecordCapacity && m_TextSize + length + 1 <= m_TextCapacity;
+        }
+
+        // NOTE : Returns the index of the record in the chunk
+        unsigned long append(const GraphCommandRecord& record, const char* text, unsigned long length)
+        {
+            GraphCommandRecord& copy = m_Records[m_RecordCount];
+            copy = record;
+            copy.Text = 0;
+
+            if (length > 0)
+            {
+                copy.Text = m_TextSize;
+                memcpy(&m_Text[m_TextSize], text, length);
+                m_Text[m_TextSize + length] = '\0';
+                m_TextSize += length + 1;
+            }
+
+            return m_RecordCount++;
+        }
+
+        inline const GraphCommandRecord& record(unsigned long index) const { return m_Records[index]; }
+        inline const char* text(unsigned long offset) const { return &m_Text[offset]; }
+
+        inline void acquire() { m_References.fetch_add(1, std::memory_order_relaxed); }
+
+        void release()
+        {
+            if (m_References.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                delete this;
+        }
+
+    private:
+        GraphCommandRecord* m_Records;
+        unsigned long m_RecordCount;
+        unsigned long m_RecordCapacity;
+
+        char* m_Text;
+        unsigned long m_TextSize;
+        unsigned long m_TextCapacity;
+
+        std::atomic<unsigned long> m_References;
+    };
+
+    GraphCommandArena()
+    {
+        m_Current = NULL;
+    }
+
+    ~GraphCommandArena()
+    {
+        if (m_Current != NULL)
+            m_Current->release();
+    }
+
+    inline std::mutex& mutex() { return m_Mutex; }
+
+    // NOTE : Arena lock held. Returns the chunk the record went to, a new one is started when the current
+    // one is full. Oversized texts get a chunk of their own.
+    Chunk* append(const GraphCommandRecord& record, const char* text, unsigned long length, unsigned long& index)
+    {
+        if (m_Current == NULL || !m_Current->fits(length))
+        {
+            unsigned long size = c_ChunkText;
+            if (length + 2 > size)
+                size = length + 2;
+
+            if (m_Current != NULL)
+                m_Current->release();
+            m_Current = new Chunk(c_ChunkRecords, size);
+        }
+
+        index = m_Current->append(record, text, length);
+        return m_Current;
+    }
+
+private:
+    static const unsigned long c_ChunkRecords = 4096;
+    static const unsigned long c_ChunkText = 65536;
+
+    std::mutex m_Mutex;
+    Chunk* m_Current;
+};
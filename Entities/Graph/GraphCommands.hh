@@ -3,6 +3,15 @@
 #include <raindance/Core/Sequencer/Sequencer.hh>
 
 #include "Entities/MVC.hh"
+#include "Core/Profiler.hh"
+
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
 
 class GraphCommand : public Sequence
 {
@@ -43,6 +52,7 @@ public:
     virtual Sequence::Status play(Timecode timecode)
     {
         (void) timecode;
+        PROFILE_ZONE("GraphCommand_SetAttribute::play");
         m_Graph->setAttribute(m_Input.Name.c_str(), m_Input.Type.c_str(), m_Input.Value.c_str());
         LOG("[COMMAND] SetAttribute{ Input : (%s, %s, %s) }\n", m_Input.Name.c_str(), m_Input.Type.c_str(), m_Input.Value.c_str());
         return KILL;
@@ -68,6 +78,7 @@ public:
     virtual Sequence::Status play(Timecode timecode)
     {
         (void) timecode;
+        PROFILE_ZONE("GraphCommand_AddNode::play");
         m_Output.ID = m_Graph->addNode(m_Input.Label.c_str());
         LOG("[COMMAND] AddNode { Input : (%s), Output : (%lu) }\n", m_Input.Label.c_str(), m_Output.ID);
         return KILL;
@@ -89,6 +100,7 @@ public:
     virtual Sequence::Status play(Timecode timecode)
     {
         (void) timecode;
+        PROFILE_ZONE("GraphCommand_RemoveNode::play");
         m_Graph->removeNode(m_Input.ID);
         LOG("[COMMAND] RemoveNode { Input : (%lu) }\n", m_Input.ID);
         return KILL;
@@ -112,6 +124,7 @@ public:
     virtual Sequence::Status play(Timecode timecode)
     {
         (void) timecode;
+        PROFILE_ZONE("GraphCommand_SetNodeAttribute::play");
         m_Graph->setNodeAttribute(m_Input.UID, m_Input.Name.c_str(), m_Input.Type.c_str(), m_Input.Value.c_str());
         LOG("[COMMAND] SetNodeAttribute { Input : (%lu, %s, %s, %s) }\n", m_Input.UID, m_Input.Name.c_str(), m_Input.Type.c_str(), m_Input.Value.c_str());
         return KILL;
@@ -139,6 +152,7 @@ public:
     virtual Sequence::Status play(Timecode timecode)
     {
         (void) timecode;
+        PROFILE_ZONE("GraphCommand_AddLink::play");
         m_Output.UID = m_Graph->addLink(m_Input.UID1, m_Input.UID2);
         LOG("[COMMAND] AddLink { Input : (%lu, %lu), Output : (%lu) }\n", m_Input.UID1, m_Input.UID2, m_Output.UID);
         return KILL;
@@ -165,6 +179,7 @@ public:
     virtual Sequence::Status play(Timecode timecode)
     {
         (void) timecode;
+        PROFILE_ZONE("GraphCommand_RemoveLink::play");
         m_Graph->removeLink(m_Input.UID);
         LOG("[COMMAND] RemoveLink { Input : (%lu) }\n", m_Input.UID);
         return KILL;
@@ -188,6 +203,7 @@ public:
     virtual Sequence::Status play(Timecode timecode)
     {
         (void) timecode;
+        PROFILE_ZONE("GraphCommand_SetLinkAttribute::play");
         m_Graph->setLinkAttribute(m_Input.UID, m_Input.Name.c_str(), m_Input.Type.c_str(), m_Input.Value.c_str());
         LOG("[COMMAND] SetLinkAttribute { Input : (%lu, %s, %s, %s) }\n", m_Input.UID, m_Input.Name.c_str(), m_Input.Type.c_str(), m_Input.Value.c_str());
         return KILL;
@@ -212,7 +228,8 @@ public:
         IVariable* name = getVariable("name", RD_STRING, variables);
         IVariable* type = getVariable("type", RD_STRING, variables);
         IVariable* value = getVariable("value", RD_STRING, variables);
-        if (name == NULL || type == NULL || value == NULL)
+        VariableType vtype;
+        if (name == NULL || type == NULL || value == NULL || !parseVariableType(static_cast<StringVariable*>(type)->value(), vtype))
             return NULL;
 
         return new GraphCommand_SetAttribute(graph,
@@ -247,7 +264,8 @@ public:
         IVariable* name = getVariable("name", RD_STRING, variables);
         IVariable* type = getVariable("type", RD_STRING, variables);
         IVariable* value = getVariable("value", RD_STRING, variables);
-        if (id == NULL || name == NULL || type == NULL || value == NULL)
+        VariableType vtype;
+        if (id == NULL || name == NULL || type == NULL || value == NULL || !parseVariableType(static_cast<StringVariable*>(type)->value(), vtype))
             return NULL;
 
         return new GraphCommand_SetNodeAttribute(graph,
@@ -286,7 +304,8 @@ public:
         IVariable* name = getVariable("name", RD_STRING, variables);
         IVariable* type = getVariable("type", RD_STRING, variables);
         IVariable* value = getVariable("value", RD_STRING, variables);
-        if (id == NULL || name == NULL || type == NULL || value == NULL)
+        VariableType vtype;
+        if (id == NULL || name == NULL || type == NULL || value == NULL || !parseVariableType(static_cast<StringVariable*>(type)->value(), vtype))
             return NULL;
 
         return new GraphCommand_SetLinkAttribute(graph,
@@ -307,3 +326,328 @@ public:
         return var;
     }
 };
+
+// NOTE : Attribute names are interned once when commands are encoded. Names are never released, their
+// addresses stay valid (deque elements don't move) so they can be read without the lock.
+class GraphAttributeNames
+{
+public:
+    static GraphAttributeNames& getInstance()
+    {
+        static GraphAttributeNames s_Instance;
+        return s_Instance;
+    }
+
+    const std::string* intern(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        auto it = m_Index.find(name);
+        if (it != m_Index.end())
+            return it->second;
+
+        m_Names.push_back(name);
+        m_Index[name] = &m_Names.back();
+        return &m_Names.back();
+    }
+
+private:
+    std::mutex m_Mutex;
+    std::deque<std::string> m_Names;
+    std::unordered_map<std::string, const std::string*> m_Index;
+};
+
+// NOTE : Run of records sharing a timecode in a chunk of the command arena. A block is a small fixed-size
+// sequence, playing it is a switch over its records, without the per-command log line.
+class GraphCommandBlock : public GraphCommand
+{
+public:
+    typedef GraphCommandRecord Record;
+
+    GraphCommandBlock(GraphEntity* graph, GraphCommandArena::Chunk* chunk, unsigned long begin, Timecode timecode)
+    : GraphCommand(graph, "CommandBlock"), m_Chunk(chunk), m_Begin(begin), m_End(begin), m_Time(timecode),
+      m_ReservedNodes(0), m_ReservedLinks(0)
+    {
+        m_Chunk->acquire();
+    }
+
+    virtual ~GraphCommandBlock()
+    {
+        m_Chunk->release();
+    }
+
+    virtual Sequence::Status play(Timecode timecode)
+    {
+        (void) timecode;
+        PROFILE_ZONE("GraphCommandBlock::play");
+
+        if (m_ReservedNodes > 0 || m_ReservedLinks > 0)
+            m_Graph->reserve(m_ReservedNodes, m_ReservedLinks);
+
+        std::string value;
+
+        for (unsigned long i = m_Begin; i < m_End; i++)
+        {
+            const Record& record = m_Chunk->record(i);
+            const char* text = m_Chunk->text(record.Text);
+
+            switch (record.Kind)
+            {
+            case Record::SET_ATTRIBUTE:
+                m_Graph->setAttribute(*record.Name, static_cast<VariableType>(record.Type), value.assign(text));
+                break;
+            case Record::ADD_NODE:
+                m_Graph->addNode(text);
+                break;
+            case Record::REMOVE_NODE:
+                m_Graph->removeNode(record.ID1);
+                break;
+            case Record::SET_NODE_ATTRIBUTE:
+                m_Graph->setNodeAttribute(record.ID1, *record.Name, static_cast<VariableType>(record.Type), value.assign(text));
+                break;
+            case Record::ADD_LINK:
+                m_Graph->addLink(record.ID1, record.ID2);
+                break;
+            case Record::REMOVE_LINK:
+                m_Graph->removeLink(record.ID1);
+                break;
+            case Record::SET_LINK_ATTRIBUTE:
+                m_Graph->setLinkAttribute(record.ID1, *record.Name, static_cast<VariableType>(record.Type), value.assign(text));
+                break;
+            }
+        }
+
+        LOG("[COMMAND] CommandBlock { %lu commands }\n", m_End - m_Begin);
+        return KILL;
+    }
+
+    inline GraphCommandArena::Chunk* chunk() const { return m_Chunk; }
+    inline void extend() { m_End++; }
+
+    // NOTE : Additions of the whole batch, announced to the views when the block is played
+    inline void reserve(unsigned long nodes, unsigned long links)
+    {
+        m_ReservedNodes = nodes;
+        m_ReservedLinks = links;
+    }
+
+    inline Timecode time() const { return m_Time; }
+    inline unsigned long size() const { return m_End - m_Begin; }
+
+private:
+    GraphCommandArena::Chunk* m_Chunk;
+    unsigned long m_Begin;
+    unsigned long m_End;
+    Timecode m_Time;
+    unsigned long m_ReservedNodes;
+    unsigned long m_ReservedLinks;
+};
+
+// NOTE : Encodes a batch of commands before they are sent to the command track. Commands are added in time
+// order, validated and encoded as plain records with their own timecode instead of one polymorphic sequence
+// each, labels and values are packed in a single text buffer. Nothing touches the track until commit().
+class GraphCommandBatch
+{
+public:
+    typedef GraphCommandRecord Record;
+
+    GraphCommandBatch()
+    {
+        // NOTE : Offset 0 is the empty string, for records without text
+        m_Text.push_back('\0');
+    }
+
+    inline void reserve(unsigned long count) { m_Records.reserve(count); }
+
+    // NOTE : Validates and encodes a command, nothing is added if it is invalid
+    bool add(Timecode timecode, const std::string& command, const Variables& variables)
+    {
+        Record record;
+        record.Time = timecode;
+        record.Type = RD_STRING;
+        record.Name = NULL;
+        record.ID1 = 0;
+        record.ID2 = 0;
+        record.Text = 0;
+
+        if (command == "graph:set_attribute" || command == "graph:set_node_attribute" || command == "graph:set_link_attribute")
+        {
+            IVariable* name = GraphCommandFactory::getVariable("name", RD_STRING, variables);
+            IVariable* type = GraphCommandFactory::getVariable("type", RD_STRING, variables);
+            IVariable* value = GraphCommandFactory::getVariable("value", RD_STRING, variables);
+            if (name == NULL || type == NULL || value == NULL)
+                return false;
+
+            VariableType vtype;
+            if (!parseVariableType(static_cast<StringVariable*>(type)->value(), vtype))
+                return false;
+
+            if (command == "graph:set_attribute")
+                record.Kind = Record::SET_ATTRIBUTE;
+            else
+            {
+                IVariable* id = GraphCommandFactory::getVariable("id", RD_INT, variables);
+                if (id == NULL)
+                    return false;
+
+                record.Kind = command == "graph:set_node_attribute" ? Record::SET_NODE_ATTRIBUTE : Record::SET_LINK_ATTRIBUTE;
+                record.ID1 = static_cast<IntVariable*>(id)->value();
+            }
+
+            record.Type = vtype;
+            record.Name = GraphAttributeNames::getInstance().intern(static_cast<StringVariable*>(name)->value());
+            record.Text = text(static_cast<StringVariable*>(value)->value());
+        }
+        else if (command == "graph:add_node")
+        {
+            IVariable* label = GraphCommandFactory::getVariable("label", RD_STRING, variables);
+            if (label == NULL)
+                return false;
+
+            record.Kind = Record::ADD_NODE;
+            record.Text = text(static_cast<StringVariable*>(label)->value());
+        }
+        else if (command == "graph:remove_node" || command == "graph:remove_link")
+        {
+            IVariable* id = GraphCommandFactory::getVariable("id", RD_INT, variables);
+            if (id == NULL)
+                return false;
+
+            record.Kind = command == "graph:remove_node" ? Record::REMOVE_NODE : Record::REMOVE_LINK;
+            record.ID1 = static_cast<IntVariable*>(id)->value();
+        }
+        else if (command == "graph:add_link")
+        {
+            IVariable* src = GraphCommandFactory::getVariable("src", RD_INT, variables);
+            IVariable* dst = GraphCommandFactory::getVariable("dst", RD_INT, variables);
+            if (src == NULL || dst == NULL)
+                return false;
+
+            record.Kind = Record::ADD_LINK;
+            record.ID1 = static_cast<IntVariable*>(src)->value();
+            record.ID2 = static_cast<IntVariable*>(dst)->value();
+        }
+        else
+        {
+            LOG("[COMMAND] Unknown command type '%s'!\n", command.c_str());
+            return false;
+        }
+
+        m_Records.push_back(record);
+        return true;
+    }
+
+    // NOTE : Write-combining of each tick of the timeline, records sharing a timecode. Only the last value set
+    // to an attribute of a node or a link is kept, and attributes of elements removed later in the tick are
+    // dropped. Additions can't be paired with removals, the IDs of new elements are only known once they are
+    // played. Every tick keeps at least its last record. Returns the number of records dropped.
+    unsigned long coalesce()
+    {
+        std::set<std::tuple<unsigned char, unsigned long, const std::string*> > written;
+        std::unordered_set<unsigned long> removedNodes;
+        std::unordered_set<unsigned long> removedLinks;
+
+        std::vector<bool> keep(m_Records.size(), true);
+        unsigned long dropped = 0;
+
+        for (unsigned long i = m_Records.size(); i > 0; i--)
+        {
+            const Record& record = m_Records[i - 1];
+
+            if (i < m_Records.size() && m_Records[i].Time != record.Time)
+            {
+                written.clear();
+                removedNodes.clear();
+                removedLinks.clear();
+            }
+
+            switch (record.Kind)
+            {
+            case Record::REMOVE_NODE:
+                removedNodes.insert(record.ID1);
+                break;
+            case Record::REMOVE_LINK:
+                removedLinks.insert(record.ID1);
+                break;
+            case Record::SET_NODE_ATTRIBUTE:
+            case Record::SET_LINK_ATTRIBUTE:
+            {
+                auto& removed = record.Kind == Record::SET_NODE_ATTRIBUTE ? removedNodes : removedLinks;
+                keep[i - 1] = removed.find(record.ID1) == removed.end()
+                    && written.insert(std::make_tuple(record.Kind, record.ID1, record.Name)).second;
+                break;
+            }
+            default:
+                break;
+            }
+
+            if (!keep[i - 1])
+                dropped++;
+        }
+
+        if (dropped == 0)
+            return 0;
+
+        unsigned long count = 0;
+        for (unsigned long i = 0; i < m_Records.size(); i++)
+            if (keep[i])
+                m_Records[count++] = m_Records[i];
+        m_Records.resize(count);
+
+        return dropped;
+    }
+
+    // NOTE : Copies the records into the arena of the track, one block per consecutive run of records sharing
+    // a timecode and a chunk. Blocks come out in time order, the first one carries the additions of the batch
+    // so that the views size their pools once instead of growing them chunk by chunk.
+    void commit(GraphEntity* graph, GraphCommandArena& arena, std::vector<GraphCommandBlock*>& blocks) const
+    {
+        std::lock_guard<std::mutex> lock(arena.mutex());
+
+        GraphCommandBlock* block = NULL;
+        unsigned long first = blocks.size();
+        unsigned long nodes = 0;
+        unsigned long links = 0;
+
+        for (auto& record : m_Records)
+        {
+            if (record.Kind == Record::ADD_NODE)
+                nodes++;
+            else if (record.Kind == Record::ADD_LINK)
+                links++;
+
+            const char* text = &m_Text[record.Text];
+            unsigned long index;
+            GraphCommandArena::Chunk* chunk = arena.append(record, text, strlen(text), index);
+
+            if (block == NULL || block->chunk() != chunk || block->time() != record.Time)
+            {
+                block = new GraphCommandBlock(graph, chunk, index, record.Time);
+                blocks.push_back(block);
+            }
+
+            block->extend();
+        }
+
+        if (blocks.size() > first)
+            blocks[first]->reserve(nodes, links);
+    }
+
+    inline unsigned long size() const { return m_Records.size(); }
+    inline const Record& record(unsigned long index) const { return m_Records[index]; }
+
+private:
+    unsigned long text(const std::string& value)
+    {
+        if (value.empty())
+            return 0;
+
+        unsigned long offset = m_Text.size();
+        m_Text.insert(m_Text.end(), value.begin(), value.end());
+        m_Text.push_back('\0');
+        return offset;
+    }
+
+    std::vector<Record> m_Records;
+    std::vector<char> m_Text;
+};
@@ -1,9 +1,29 @@
 #pragma once
 
 #include "Entities/Graph/GraphModel.hh"
+#include "Entities/Graph/GraphJournal.hh"
+#include "Entities/Graph/GraphCommandArena.hh"
+
+#include <atomic>
 
 class GraphContext : public EntityContext
 {
+public:
+    GraphContext() : m_CommandUpdatePending(false) {}
+
+    // NOTE : One "command update" message per batch of commands is enough for the sequencer to pick them all up.
+    // Returns true if the caller has to push it. May be called from the scripting threads.
+    inline bool requestCommandUpdate() { return !m_CommandUpdatePending.exchange(true); }
+
+    // NOTE : Called once the pending messages have been processed
+    inline void clearCommandUpdate() { m_CommandUpdatePending.store(false); }
+
+    // NOTE : Records of the batches sent to the command track
+    inline GraphCommandArena& commandArena() { return m_CommandArena; }
+
+private:
+    std::atomic<bool> m_CommandUpdatePending;
+    GraphCommandArena m_CommandArena;
 };
 
 class GraphListener : public EntityListener
@@ -38,6 +58,10 @@ public:
 
     virtual void onAddSphere(Sphere::ID uid, const char* label)
     { (void) uid; (void) label; }
+
+    // NOTE : About to receive that many new nodes and links, listeners may size their pools up front
+    virtual void onReserve(unsigned long nodes, unsigned long links)
+    { (void) nodes; (void) links; }
 };
 
 class GraphView : public EntityView, public GraphListener
@@ -85,8 +109,12 @@ public:
 
         id = m_GraphModel->addNode(Node::DISK, data);
 
+        if (journaling())
+            journal(GraphJournal::ADD_NODE, id, 0, 0, RD_STRING, std::string(), data.Label);
+
         for (auto l : listeners())
-            static_cast<GraphListener*>(l)->onAddNode(id, label);
+            if (!suspended(l))
+                static_cast<GraphListener*>(l)->onAddNode(id, label);
 
         return id;
     }
@@ -95,16 +123,24 @@ public:
     {
         m_GraphModel->removeNode(id);
 
+        if (journaling())
+            journal(GraphJournal::REMOVE_NODE, id);
+
         for (auto l : listeners())
-            static_cast<GraphListener*>(l)->onRemoveNode(id);
+            if (!suspended(l))
+                static_cast<GraphListener*>(l)->onRemoveNode(id);
     }
 
     void tagNode(Node::ID node, Sphere::ID sphere)
     {
         m_GraphModel->sphere(sphere).data().Nodes.push_back(node);
 
+        if (journaling())
+            journal(GraphJournal::TAG_NODE, node, sphere);
+
         for (auto l : listeners())
-            static_cast<GraphListener*>(l)->onTagNode(node, sphere);
+            if (!suspended(l))
+                static_cast<GraphListener*>(l)->onTagNode(node, sphere);
     }
 
     unsigned long countNodes() { return m_GraphModel->countNodes(); }
@@ -127,39 +163,26 @@ public:
         data.Label.assign(label);
         m_GraphModel->node(id)->data(data);
 
+        if (journaling())
+            journal(GraphJournal::SET_NODE_LABEL, id, 0, 0, RD_STRING, std::string(), data.Label);
+
         for (auto l : listeners())
-            static_cast<GraphListener*>(l)->onSetNodeLabel(id, label);
+            if (!suspended(l))
+                static_cast<GraphListener*>(l)->onSetNodeLabel(id, label);
     }
 
     const char* getNodeLabel(Node::ID id) { return m_GraphModel->node(id)->data().Label.c_str(); };
 
     void setNodeAttribute(Node::ID id, const char* name, const char* type, const char* value)
     {
-        std::string sname(name);
-        std::string stype(type);
-        std::string svalue(value);
-
         VariableType vtype;
+        if (parseVariableType(std::string(type), vtype))
+            setNodeAttribute(id, std::string(name), vtype, std::string(value));
+    }
 
-        if (stype == "float")
-            vtype = RD_FLOAT;
-        else if (stype == "string")
-            vtype = RD_STRING;
-        else if (stype == "int")
-            vtype = RD_INT;
-        else if (stype == "bool")
-            vtype = RD_BOOLEAN;
-        else if (stype == "vec2")
-            vtype = RD_VEC2;
-        else if (stype == "vec3")
-            vtype = RD_VEC3;
-        else if (stype == "vec4")
-            vtype = RD_VEC4;
-        else
-        {
-            std::cout << "Unknown attribute type \"" << stype << "\" !" << std::endl;
-            return;
-        }
+    void setNodeAttribute(Node::ID id, const std::string& name, VariableType vtype, const std::string& svalue)
+    {
+        std::string sname(name);
 
         unsigned long pos = sname.find(":");
         std::string category = sname.substr (0, pos);
@@ -174,8 +197,12 @@ public:
             m_GraphModel->node(id)->attributes().set(sname, vtype, svalue);
         }
 
+        if (journaling())
+            journal(GraphJournal::SET_NODE_ATTRIBUTE, id, 0, 0, vtype, sname, svalue);
+
         for (auto l : listeners())
-            static_cast<GraphListener*>(l)->onSetNodeAttribute(id, sname, vtype, svalue);
+            if (!suspended(l))
+                static_cast<GraphListener*>(l)->onSetNodeAttribute(id, sname, vtype, svalue);
     }
 
     IVariable* getNodeAttribute(Node::ID id, const char* name)
@@ -196,7 +223,10 @@ public:
             for (auto v : views())
             {
                 if (view == std::string(v->name()))
+                {
+                    sync(static_cast<GraphView*>(v));
                     return static_cast<GraphView*>(v)->getNodeAttribute(id, rest);
+                }
             }
             return NULL;
         }
@@ -221,8 +251,12 @@ public:
 
         uid = m_GraphModel->addLink(Link::DEFAULT, data);
 
+        if (journaling())
+            journal(GraphJournal::ADD_LINK, uid, uid1, uid2);
+
         for (auto l : listeners())
-            static_cast<GraphListener*>(l)->onAddLink(uid, uid1, uid2);
+            if (!suspended(l))
+                static_cast<GraphListener*>(l)->onAddLink(uid, uid1, uid2);
 
         return uid;
     }
@@ -231,8 +265,12 @@ public:
     {
         m_GraphModel->removeLink(id);
 
+        if (journaling())
+            journal(GraphJournal::REMOVE_LINK, id);
+
         for (auto l : listeners())
-            static_cast<GraphListener*>(l)->onRemoveLink(id);
+            if (!suspended(l))
+                static_cast<GraphListener*>(l)->onRemoveLink(id);
     }
 
     unsigned long countLinks() { return m_GraphModel->countLinks(); }
@@ -255,31 +293,14 @@ public:
 
     void setLinkAttribute(Link::ID id, const char* name, const char* type, const char* value)
     {
-        std::string sname(name);
-        std::string stype(type);
-        std::string svalue(value);
-
         VariableType vtype;
+        if (parseVariableType(std::string(type), vtype))
+            setLinkAttribute(id, std::string(name), vtype, std::string(value));
+    }
 
-        if (stype == "float")
-            vtype = RD_FLOAT;
-        else if (stype == "string")
-            vtype = RD_STRING;
-        else if (stype == "int")
-            vtype = RD_INT;
-        else if (stype == "bool")
-            vtype = RD_BOOLEAN;
-        else if (stype == "vec2")
-            vtype = RD_VEC2;
-        else if (stype == "vec3")
-            vtype = RD_VEC3;
-        else if (stype == "vec4")
-            vtype = RD_VEC4;
-        else
-        {
-            std::cout << "Unknown attribute type \"" << stype << "\" !" << std::endl;
-            return;
-        }
+    void setLinkAttribute(Link::ID id, const std::string& name, VariableType vtype, const std::string& svalue)
+    {
+        std::string sname(name);
 
         unsigned long pos = sname.find(":");
         std::string category = sname.substr (0, pos);
@@ -294,8 +315,12 @@ public:
             m_GraphModel->link(id)->attributes().set(sname, vtype, svalue);
         }
 
+        if (journaling())
+            journal(GraphJournal::SET_LINK_ATTRIBUTE, id, 0, 0, vtype, sname, svalue);
+
         for (auto l : listeners())
-            static_cast<GraphListener*>(l)->onSetLinkAttribute(id, sname, vtype, svalue);
+            if (!suspended(l))
+                static_cast<GraphListener*>(l)->onSetLinkAttribute(id, sname, vtype, svalue);
     }
 
     IVariable* getLinkAttribute(Link::ID id, const char* name)
@@ -316,7 +341,10 @@ public:
             for (auto v : views())
             {
                 if (view == std::string(v->name()))
+                {
+                    sync(static_cast<GraphView*>(v));
                     return static_cast<GraphView*>(v)->getLinkAttribute(id, rest);
+                }
             }
             return NULL;
         }
@@ -341,8 +369,12 @@ public:
 
         id = m_GraphModel->addSphere(Sphere::DEFAULT, data);
 
+        if (journaling())
+            journal(GraphJournal::ADD_SPHERE, id, 0, 0, RD_STRING, std::string(), data.Label);
+
         for (auto l : listeners())
-            static_cast<GraphListener*>(l)->onAddSphere(id, label);
+            if (!suspended(l))
+                static_cast<GraphListener*>(l)->onAddSphere(id, label);
 
         return id;
     }
@@ -361,8 +393,12 @@ public:
 
         element = m_GraphModel->addNeighbor(ntype, ndata, Link::DEFAULT, ldata, neighbor);
 
+        if (journaling())
+            journal(GraphJournal::ADD_NEIGHBOR, element.first, element.second, neighbor, RD_STRING, std::string(), ndata.Label);
+
         for (auto l : listeners())
-            static_cast<GraphListener*>(l)->onAddNeighbor(element, label, neighbor);
+            if (!suspended(l))
+                static_cast<GraphListener*>(l)->onAddNeighbor(element, label, neighbor);
 
         return element;
     }
@@ -371,11 +407,136 @@ public:
 
     Node::ID getSelectedNode(unsigned int index) { return m_GraphModel->selectedNode(index).id(); }
 
+    // NOTE : Hint sent ahead of a batch of additions, suspended listeners catch up through the journal later
+    void reserve(unsigned long nodes, unsigned long links)
+    {
+        for (auto l : listeners())
+            if (!suspended(l))
+                static_cast<GraphListener*>(l)->onReserve(nodes, links);
+    }
+
+    // ----- Journal -----
+
+    // NOTE : Suspended listeners stop receiving mutations, they are journaled and replayed on resume instead.
+    void suspend(EntityListener* listener) override
+    {
+        if (m_Cursors.find(listener) == m_Cursors.end())
+            m_Cursors[listener] = m_Journal.end();
+    }
+
+    void resume(EntityListener* listener) override
+    {
+        auto it = m_Cursors.find(listener);
+        if (it == m_Cursors.end())
+            return;
+
+        replay(static_cast<GraphListener*>(listener), it->second);
+        m_Cursors.erase(it);
+        trim();
+    }
+
+    // NOTE : Brings a suspended listener up to date without resuming it, before it is queried
+    void sync(EntityListener* listener) override
+    {
+        auto it = m_Cursors.find(listener);
+        if (it == m_Cursors.end() || it->second == m_Journal.end())
+            return;
+
+        replay(static_cast<GraphListener*>(listener), it->second);
+        it->second = m_Journal.end();
+        trim();
+    }
+
+    inline bool journaling() const { return !m_Cursors.empty(); }
+    inline bool suspended(EntityListener* listener) const { return !m_Cursors.empty() && m_Cursors.find(listener) != m_Cursors.end(); }
+
     // ----- Entity Properties -----
 
     inline GraphModel* model() { return m_GraphModel; }
     inline EntityContext* context() { return m_GraphContext; }
 private:
+    void journal(GraphJournal::Type kind, unsigned long id1, unsigned long id2 = 0, unsigned long id3 = 0,
+                 VariableType vtype = RD_STRING, const std::string& name = std::string(), const std::string& value = std::string())
+    {
+        m_Journal.push(kind, id1, id2, id3, vtype, name, value);
+
+        if (m_Journal.full())
+        {
+            std::vector<unsigned long> positions;
+            for (auto& cursor : m_Cursors)
+                positions.push_back(cursor.second);
+
+            m_Journal.compact(positions);
+
+            unsigned long i = 0;
+            for (auto& cursor : m_Cursors)
+                cursor.second = positions[i++];
+        }
+    }
+
+    void replay(GraphListener* listener, unsigned long from)
+    {
+        std::vector<const GraphJournal::Entry*> entries;
+        m_Journal.collect(from, entries);
+
+        LOG("[GRAPH] Replaying %lu of %lu journaled changes\n", (unsigned long) entries.size(), m_Journal.end() - from);
+
+        for (auto entry : entries)
+        {
+            switch (entry->Kind)
+            {
+            case GraphJournal::ADD_NODE:
+                listener->onAddNode(entry->ID1, entry->Value.c_str());
+                break;
+            case GraphJournal::REMOVE_NODE:
+                listener->onRemoveNode(entry->ID1);
+                break;
+            case GraphJournal::SET_NODE_ATTRIBUTE:
+                listener->onSetNodeAttribute(entry->ID1, entry->Name, entry->VType, entry->Value);
+                break;
+            case GraphJournal::SET_NODE_LABEL:
+                listener->onSetNodeLabel(entry->ID1, entry->Value.c_str());
+                break;
+            case GraphJournal::TAG_NODE:
+                listener->onTagNode(entry->ID1, entry->ID2);
+                break;
+            case GraphJournal::ADD_LINK:
+                listener->onAddLink(entry->ID1, entry->ID2, entry->ID3);
+                break;
+            case GraphJournal::REMOVE_LINK:
+                listener->onRemoveLink(entry->ID1);
+                break;
+            case GraphJournal::SET_LINK_ATTRIBUTE:
+                listener->onSetLinkAttribute(entry->ID1, entry->Name, entry->VType, entry->Value);
+                break;
+            case GraphJournal::ADD_NEIGHBOR:
+                listener->onAddNeighbor(std::make_pair(entry->ID1, entry->ID2), entry->Value.c_str(), entry->ID3);
+                break;
+            case GraphJournal::ADD_SPHERE:
+                listener->onAddSphere(entry->ID1, entry->Value.c_str());
+                break;
+            }
+        }
+    }
+
+    void trim()
+    {
+        if (m_Cursors.empty())
+        {
+            m_Journal.clear();
+            return;
+        }
+
+        unsigned long until = m_Journal.end();
+        for (auto& cursor : m_Cursors)
+            if (cursor.second < until)
+                until = cursor.second;
+        m_Journal.trim(until);
+    }
+
     GraphContext* m_GraphContext;
     GraphModel* m_GraphModel;
+
+    GraphJournal m_Journal;
+    std::map<EntityListener*, unsigned long> m_Cursors;
 };
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <raindance/Core/Variables.hh>
+
+#include <deque>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+// NOTE : Log of the graph mutations that suspended listeners (views of inactive visualizers) haven't seen yet.
+// Positions are absolute sequence numbers, the entries every cursor went past are dropped. Remote IDs are
+// never reused by the model, which is what makes coalescing on IDs safe. While a listener stays suspended the
+// journal is compacted whenever it doubles, so repeated attribute and label updates don't pile up.
+class GraphJournal
+{
+public:
+    enum Type
+    {
+        ADD_NODE,
+        REMOVE_NODE,
+        SET_NODE_ATTRIBUTE,
+        SET_NODE_LABEL,
+        TAG_NODE,
+        ADD_LINK,
+        REMOVE_LINK,
+        SET_LINK_ATTRIBUTE,
+        ADD_NEIGHBOR,
+        ADD_SPHERE
+    };
+
+    // NOTE : IDs and strings are used according to the type:
+    //   ADD_NODE (node, label), REMOVE_NODE (node), SET_NODE_ATTRIBUTE (node, name, type, value),
+    //   SET_NODE_LABEL (node, label), TAG_NODE (node, sphere), ADD_LINK (link, node1, node2),
+    //   REMOVE_LINK (link), SET_LINK_ATTRIBUTE (link, name, type, value),
+    //   ADD_NEIGHBOR (node, link, neighbor, label), ADD_SPHERE (sphere, label)
+    struct Entry
+    {
+        Type Kind;
+        unsigned long ID1;
+        unsigned long ID2;
+        unsigned long ID3;
+        VariableType VType;
+        std::string Name;
+        std::string Value;
+    };
+
+    GraphJournal()
+    {
+        m_Base = 0;
+        m_CompactAt = c_MinCompact;
+    }
+
+    void push(Type kind, unsigned long id1, unsigned long id2 = 0, unsigned long id3 = 0,
+              VariableType vtype = RD_STRING, const std::string& name = std::string(), const std::string& value = std::string())
+    {
+        m_Entries.push_back(Entry());
+
+        Entry& entry = m_Entries.back();
+        entry.Kind = kind;
+        entry.ID1 = id1;
+        entry.ID2 = id2;
+        entry.ID3 = id3;
+        entry.VType = vtype;
+        entry.Name = name;
+        entry.Value = value;
+    }
+
+    inline unsigned long begin() const { return m_Base; }
+    inline unsigned long end() const { return m_Base + m_Entries.size(); }
+
+    // NOTE : Time to compact, the threshold follows the size of the compacted journal
+    inline bool full() const { return m_Entries.size() >= m_CompactAt; }
+
+    // NOTE : Entries from 'from' to the end, in order, without the ones a later entry makes redundant:
+    // attributes and labels set again later, and anything but the removal of an element removed later.
+    void collect(unsigned long from, std::vector<const Entry*>& entries) const
+    {
+        entries.clear();
+        if (from < m_Base)
+            from = m_Base;
+
+        std::vector<bool> keep;
+        mark(from, keep);
+
+        for (unsigned long i = from; i < end(); i++)
+            if (keep[i - from])
+                entries.push_back(&m_Entries[i - m_Base]);
+    }
+
+    // NOTE : Drops the redundant entries for good. Whether an entry is redundant doesn't depend on the cursors,
+    // a listener that hasn't seen it yet will see the entry superseding it. Positions are remapped in place
+    // to the first kept entry at or after them.
+    void compact(std::vector<unsigned long>& positions)
+    {
+        std::vector<bool> keep;
+        mark(m_Base, keep);
+
+        std::vector<unsigned long> kept(m_Entries.size() + 1);
+        kept[0] = 0;
+        for (unsigned long i = 0; i < m_Entries.size(); i++)
+            kept[i + 1] = kept[i] + (keep[i] ? 1 : 0);
+
+        for (auto& position : positions)
+            if (position > m_Base)
+                position = m_Base + kept[position - m_Base];
+
+        std::deque<Entry> entries;
+        for (unsigned long i = 0; i < m_Entries.size(); i++)
+            if (keep[i])
+                entries.push_back(std::move(m_Entries[i]));
+        m_Entries.swap(entries);
+
+        m_CompactAt = 2 * m_Entries.size();
+        if (m_CompactAt < c_MinCompact)
+            m_CompactAt = c_MinCompact;
+    }
+
+    // NOTE : Drops the entries before 'until'
+    void trim(unsigned long until)
+    {
+        while (m_Base < until && !m_Entries.empty())
+        {
+            m_Entries.pop_front();
+            m_Base++;
+        }
+    }
+
+    void clear()
+    {
+        m_Base = end();
+        m_Entries.clear();
+        m_CompactAt = c_MinCompact;
+    }
+
+private:
+    static const unsigned long c_MinCompact = 65536;
+
+    // NOTE : Walks backwards from the end, an entry is kept unless a later one makes it redundant
+    void mark(unsigned long from, std::vector<bool>& keep) const
+    {
+        keep.assign(end() - from, true);
+
+        std::set<unsigned long> removedNodes;
+        std::set<unsigned long> removedLinks;
+        std::set<std::pair<unsigned long, std::string> > nodeKeys;
+        std::set<std::pair<unsigned long, std::string> > linkKeys;
+
+        for (unsigned long i = end(); i > from; i--)
+        {
+            const Entry& entry = m_Entries[i - 1 - m_Base];
+
+            switch (entry.Kind)
+            {
+            case REMOVE_NODE:
+                removedNodes.insert(entry.ID1);
+                break;
+            case REMOVE_LINK:
+                removedLinks.insert(entry.ID1);
+                break;
+            case SET_NODE_ATTRIBUTE:
+            case SET_NODE_LABEL:
+                // NOTE : Labels can't clash with attribute names, those are never empty
+                keep[i - 1 - from] = removedNodes.count(entry.ID1) == 0
+                    && nodeKeys.insert(std::make_pair(entry.ID1, entry.Kind == SET_NODE_LABEL ? std::string() : entry.Name)).second;
+                break;
+            case TAG_NODE:
+                keep[i - 1 - from] = removedNodes.count(entry.ID1) == 0;
+                break;
+            case SET_LINK_ATTRIBUTE:
+                keep[i - 1 - from] = removedLinks.count(entry.ID1) == 0
+                    && linkKeys.insert(std::make_pair(entry.ID1, entry.Name)).second;
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    unsigned long m_Base;
+    unsigned long m_CompactAt;
+    std::deque<Entry> m_Entries;
+};
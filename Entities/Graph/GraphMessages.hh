@@ -28,6 +28,7 @@ struct GraphNodeUnselectedMessage : public IMessage
 	unsigned long ID;
 };
 
+// NOTE : Carries the remote ID of the node, local IDs may be remapped by a compaction while the message is pending
 struct GraphTargetNodeMessage : public IMessage
 {
 	GraphTargetNodeMessage(unsigned long id) : ID(id) {}
@@ -40,6 +40,171 @@ private:
 	std::unordered_map<T, U> m_Remote;
 };
 
+// NOTE : Same as TranslationMap for IDs handed out by counters, both directions are plain vectors indexed
+// by ID. Remote IDs are never reused, the local side can be packed with remapLocalIDs after a compaction.
+//
+// Removals leave the low end of the remote range empty for good. Once most of it is empty, remote IDs
+// move to a hash map and the map stops growing with every ID ever handed out.
+template <class T, class U>
+class DenseTranslationMap
+{
+public:
+	static const unsigned long Invalid = (unsigned long) -1;
+
+	DenseTranslationMap() : m_Count(0), m_Sparse(false) {}
+
+	void addRemoteID(T rid, U lid)
+	{
+		if (!m_Sparse && rid >= m_Local.size() && isSparse(rid + 1, m_Count + 1))
+			sparsify();
+
+		if (lid >= m_Remote.size())
+			m_Remote.resize(lid + 1, Invalid);
+
+		if (m_Sparse)
+		{
+			if (m_SparseLocal.insert(std::make_pair(rid, lid)).second)
+				m_Count++;
+			else
+				m_SparseLocal[rid] = lid;
+		}
+		else
+		{
+			if (rid >= m_Local.size())
+				m_Local.resize(rid + 1, Invalid);
+
+			if (m_Local[rid] == Invalid)
+				m_Count++;
+			m_Local[rid] = lid;
+		}
+
+		m_Remote[lid] = rid;
+	}
+
+	void eraseRemoteID(T rid, U lid)
+	{
+		if (m_Sparse)
+		{
+			m_Count -= m_SparseLocal.erase(rid);
+		}
+		else if (rid < m_Local.size() && m_Local[rid] != Invalid)
+		{
+			m_Local[rid] = Invalid;
+			m_Count--;
+
+			if (isSparse(m_Local.size(), m_Count))
+				sparsify();
+		}
+
+		if (lid < m_Remote.size())
+			m_Remote[lid] = Invalid;
+	}
+
+	void removeLocalID(U lid)
+	{
+		if (containsLocalID(lid))
+			eraseRemoteID(m_Remote[lid], lid);
+	}
+
+	inline bool containsRemoteID(T rid) const { return getLocalID(rid) != Invalid; }
+	inline bool containsLocalID(U lid) const { return lid < m_Remote.size() && m_Remote[lid] != Invalid; }
+
+	inline U getLocalID(T rid) const
+	{
+		if (m_Sparse)
+		{
+			auto it = m_SparseLocal.find(rid);
+			return it != m_SparseLocal.end() ? it->second : Invalid;
+		}
+		return rid < m_Local.size() ? m_Local[rid] : Invalid;
+	}
+
+	inline T getRemoteID(U lid) const { return lid < m_Remote.size() ? m_Remote[lid] : Invalid; }
+
+	inline unsigned long count() const { return m_Count; }
+
+	// NOTE : remap[old local ID] is the new local ID, or Invalid for the IDs that were dropped
+	void remapLocalIDs(const std::vector<U>& remap)
+	{
+		std::vector<T> remote;
+
+		if (m_Sparse)
+		{
+			for (auto it = m_SparseLocal.begin(); it != m_SparseLocal.end();)
+			{
+				U lid = it->second < remap.size() ? remap[it->second] : Invalid;
+				if (lid == Invalid)
+				{
+					it = m_SparseLocal.erase(it);
+					m_Count--;
+					continue;
+				}
+
+				it->second = lid;
+				if (lid >= remote.size())
+					remote.resize(lid + 1, Invalid);
+				remote[lid] = it->first;
+				++it;
+			}
+		}
+		else
+		{
+			for (T rid = 0; rid < m_Local.size(); rid++)
+			{
+				U lid = m_Local[rid];
+				if (lid == Invalid)
+					continue;
+
+				lid = lid < remap.size() ? remap[lid] : Invalid;
+				m_Local[rid] = lid;
+
+				if (lid == Invalid)
+				{
+					m_Count--;
+					continue;
+				}
+
+				if (lid >= remote.size())
+					remote.resize(lid + 1, Invalid);
+				remote[lid] = rid;
+			}
+		}
+
+		m_Remote.swap(remote);
+	}
+
+private:
+	// NOTE : The dense side costs one entry per remote ID handed out, live or not
+	static inline bool isSparse(unsigned long range, unsigned long count)
+	{
+		const unsigned long c_MinRange = 65536;
+		const unsigned long c_MaxEmptyRatio = 8;
+
+		return range >= c_MinRange && range > c_MaxEmptyRatio * count;
+	}
+
+	void sparsify()
+	{
+		m_SparseLocal.reserve(m_Count);
+		for (T rid = 0; rid < m_Local.size(); rid++)
+			if (m_Local[rid] != Invalid)
+				m_SparseLocal[rid] = m_Local[rid];
+
+		std::vector<U>().swap(m_Local);
+		m_Sparse = true;
+	}
+
+	std::vector<U> m_Local;
+	std::unordered_map<T, U> m_SparseLocal;
+	std::vector<T> m_Remote;
+	unsigned long m_Count;
+	bool m_Sparse;
+};
+
+// NOTE : Bound to const references by resize, the constant needs storage
+template <class T, class U>
+const unsigned long DenseTranslationMap<T, U>::Invalid;
+
 class Node
 {
 public:
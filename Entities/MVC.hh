@@ -8,6 +8,8 @@
 
 #include "Core/Console.hh"
 
+#include <atomic>
+
 // TODO : This should probably all be moved into the Raindance engine
 
 // ------------------------
@@ -49,9 +51,32 @@ EntityModel::~EntityModel() {}
 class EntityView : public View, public EntityBase
 {
 public:
+    EntityView() : m_Invalidated(true) {}
     virtual ~EntityView() = 0;
     virtual const char* name() const = 0;
     virtual IVariable* getAttribute(const std::string& name) = 0;
+
+    // NOTE : Render-on-demand. Views that don't track their changes are redrawn every frame.
+    virtual bool needsRedraw() { return true; }
+
+    // NOTE : One fixed step of simulation, run as many times as the frame scheduler says, possibly none.
+    // Everything else a view has to keep up to date belongs to idle(), which runs once per frame.
+    virtual void step() {}
+
+    // NOTE : May be called from the scripting threads, the main loop is woken up if it is waiting for events.
+    void invalidate()
+    {
+        if (m_Invalidated.exchange(true))
+            return;
+
+#if !defined(EMSCRIPTEN) && (GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 1))
+        glfwPostEmptyEvent();
+#endif
+    }
+
+protected:
+    // NOTE : Views clear it with exchange(false) before drawing, an invalidation racing with the draw stays pending
+    std::atomic<bool> m_Invalidated;
 };
 
 EntityView::~EntityView() {}
@@ -64,27 +89,37 @@ public:
     virtual ~EntityController() = 0;
     virtual void draw() {}
     virtual void idle() {}
+    virtual bool needsRedraw() { return false; }
 };
 
 EntityController::~EntityController() {}
 
 // ------------------------
 
+class EntityListener;
+
 class EntityVisualizer : public EntityBase
 {
 public:
+    EntityVisualizer() : m_EntityView(NULL), m_EntityController(NULL), m_Entity(NULL) {}
     virtual ~EntityVisualizer() {}
     virtual bool bind(const Viewport& viewport, Entity* entity) = 0;
     virtual EntityView* view() { return m_EntityView; }
     virtual EntityController* controller() { return m_EntityController; }
 
+    // NOTE : Listeners of an inactive visualizer are suspended, the entity catches them up when it becomes active again
+    void setActive(bool active);
+
 protected:
     void set(EntityView* view) { m_EntityView = view; }
     void set(EntityController* controller) { m_EntityController = controller; }
+    void listen(Entity* entity, EntityListener* listener) { m_Entity = entity; m_Listeners.push_back(listener); }
 
 private:
     EntityView* m_EntityView;
     EntityController* m_EntityController;
+    Entity* m_Entity;
+    std::vector<EntityListener*> m_Listeners;
 };
 
 class EntityVisualizerManager : public Manager<EntityVisualizer>
@@ -107,6 +142,32 @@ EntityListener::~EntityListener() {}
 
 // ------------------------
 
+// NOTE : Attribute types as spelled by the scripting API
+inline bool parseVariableType(const std::string& type, VariableType& vtype)
+{
+    if (type == "float")
+        vtype = RD_FLOAT;
+    else if (type == "string")
+        vtype = RD_STRING;
+    else if (type == "int")
+        vtype = RD_INT;
+    else if (type == "bool")
+        vtype = RD_BOOLEAN;
+    else if (type == "vec2")
+        vtype = RD_VEC2;
+    else if (type == "vec3")
+        vtype = RD_VEC3;
+    else if (type == "vec4")
+        vtype = RD_VEC4;
+    else
+    {
+        std::cout << "Unknown attribute type \"" << type << "\" !" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
 class Entity : public EntityBase
 {
 public:
@@ -135,30 +196,20 @@ public:
 
     virtual void send(const Variables& input, Variables& output) = 0;
 
+    // NOTE : Entities that can't journal their changes keep notifying suspended listeners
+    virtual void suspend(EntityListener* listener) { (void) listener; }
+    virtual void resume(EntityListener* listener) { (void) listener; }
+    virtual void sync(EntityListener* listener) { (void) listener; }
+
     void setAttribute(const std::string& name, const std::string& type, const std::string& value)
     {
         VariableType vtype;
+        if (parseVariableType(type, vtype))
+            setAttribute(name, vtype, value);
+    }
 
-        if (type == "float")
-            vtype = RD_FLOAT;
-        else if (type == "string")
-            vtype = RD_STRING;
-        else if (type == "int")
-            vtype = RD_INT;
-        else if (type == "bool")
-            vtype = RD_BOOLEAN;
-        else if (type == "vec2")
-            vtype = RD_VEC2;
-        else if (type == "vec3")
-            vtype = RD_VEC3;
-        else if (type == "vec4")
-            vtype = RD_VEC4;
-        else
-        {
-            std::cout << "Unknown attribute type \"" << type << "\" !" << std::endl;
-            return;
-        }
-
+    void setAttribute(const std::string& name, VariableType vtype, const std::string& value)
+    {
         unsigned long pos = name.find(":");
         std::string category = name.substr (0, pos);
         std::string sname = name;
@@ -173,8 +224,12 @@ public:
             model()->attributes().set(sname, vtype, value);
         }
 
+        // NOTE : Attributes reach suspended listeners right away, after the changes they haven't seen yet
         for (auto l : listeners())
+        {
+            sync(l);
             l->onSetAttribute(sname, vtype, value);
+        }
     }
 
     IVariable* getAttribute(const std::string& name)
@@ -222,6 +277,20 @@ private:
     std::vector<EntityListener*> m_Listeners;
 };
 
+void EntityVisualizer::setActive(bool active)
+{
+    if (m_Entity == NULL)
+        return;
+
+    for (auto listener : m_Listeners)
+    {
+        if (active)
+            m_Entity->resume(listener);
+        else
+            m_Entity->suspend(listener);
+    }
+}
+
 #include "Graph/GraphEntity.hh"
 #include "TimeSeries/TimeSeriesEntity.hh"
 
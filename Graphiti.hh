@@ -3,12 +3,17 @@
 #include <raindance/Raindance.hh>
 #include <raindance/Core/Debug.hh>
 
+#include <thread>
+#include <chrono>
+
 #include "Pack.hh"
 
 #include "Entities/MVC.hh"
 
 #include "Core/Console.hh"
 #include "Core/Window.hh"
+#include "Core/FrameScheduler.hh"
+#include "Core/CommandQueue.hh"
 
 #include "Visualizers/Space/SpaceVisualizer.hh"
 #include "Visualizers/World/WorldVisualizer.hh"
@@ -26,6 +31,9 @@ public:
     Graphiti(int argc, char** argv)
     : Raindance(argc, argv), m_Console(NULL)
     {
+        IdleTimeout = 0.1;
+        CommandBudget = 4.0;
+
         SAFE_DELETE(m_Console);
         m_Console = new GraphitiConsole(argc, argv);
     }
@@ -53,6 +61,41 @@ public:
         add(window);
     }
 
+    // NOTE : Rendering without a visible window. On a server, this needs a GLFW build backed by a headless
+    // platform (Ex: OSMesa or EGL) or a virtual display.
+    virtual void createOffscreenWindow(const char* title, int width, int height)
+    {
+        glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+        auto window = new GLWindow(title, width, height, this, true);
+        glfwWindowHint(GLFW_VISIBLE, GL_TRUE);
+
+        add(window);
+    }
+
+    void screenshot(const char* filename)
+    {
+        auto window = static_cast<GLWindow*>(windows().active());
+        if (window == NULL)
+        {
+            LOG("[GRAPHITI] Can't take a screenshot without a window!\n");
+            return;
+        }
+
+        window->capture().screenshot(filename);
+    }
+
+    void record(const char* prefix, unsigned int frames)
+    {
+        auto window = static_cast<GLWindow*>(windows().active());
+        if (window == NULL)
+        {
+            LOG("[GRAPHITI] Can't record frames without a window!\n");
+            return;
+        }
+
+        window->capture().record(prefix, frames);
+    }
+
     virtual EntityManager::ID createEntity(const char* type)
     {
         std::string stype = type;
@@ -150,26 +193,86 @@ public:
 
     void idle() override
     {
-        m_Console->idle(context()->clock());
+        {
+            PROFILE_ZONE("Graphiti::idle");
+            Stats::Timer timer(Stats::IDLE);
 
-        Raindance::idle();
+            {
+                PROFILE_ZONE("Console::idle");
+                m_Console->idle(context()->clock());
+            }
 
-        if (m_EntityManager.active() != NULL)
-            m_EntityManager.active()->context()->sequencer().play();
+            Raindance::idle();
 
-        for (auto e : m_EntityManager.elements())
-        {
-            for (auto c : e.second->controllers())
-                c->idle();
-            for (auto v : e.second->views())
-                v->idle();
+            if (m_EntityManager.active() != NULL)
+                m_EntityManager.active()->context()->sequencer().play();
+
+            {
+                PROFILE_ZONE("Graphiti::simulate");
+                Stats::Timer simulation(Stats::SIMULATION);
+
+                unsigned int steps = m_Scheduler.begin();
+                for (unsigned int i = 0; i < steps; i++)
+                    for (auto e : m_EntityManager.elements())
+                        for (auto v : e.second->views())
+                            v->step();
+
+                Stats::getInstance().substeps(steps);
+
+                // NOTE : Housekeeping runs every frame, even when no step is due, so changes show up right away
+                for (auto e : m_EntityManager.elements())
+                {
+                    for (auto c : e.second->controllers())
+                        c->idle();
+                    for (auto v : e.second->views())
+                        v->idle();
+                }
+            }
+
+            PROFILE_ZONE("MessageQueue::process");
+            Stats::Timer messages(Stats::MESSAGES);
+
+            m_Context->messages().process();
+
+            CommandQueue::getInstance().process(CommandBudget);
+
+            // TODO : We shoud align every message on Graphiti.context()
+            if (m_EntityManager.active() != NULL)
+            {
+                // NOTE : Cleared first, commands sent while processing push a new update
+                if (m_EntityManager.active()->type() == Entity::GRAPH)
+                    static_cast<GraphContext*>(m_EntityManager.active()->context())->clearCommandUpdate();
+
+                m_EntityManager.active()->context()->messages().process();
+            }
         }
 
-        m_Context->messages().process();
+        // NOTE : Commands left over by the budget are processed on the next iteration, without waiting
+        if (!needsRedraw() && CommandQueue::getInstance().size() == 0)
+            waitEvents(IdleTimeout);
+    }
+
+    bool needsRedraw()
+    {
+        auto window = static_cast<GLWindow*>(windows().active());
+        return window == NULL || window->needsRedraw();
+    }
 
-        // TODO : We shoud align every message on Graphiti.context()
-        if (m_EntityManager.active() != NULL)
-            m_EntityManager.active()->context()->messages().process();
+    // NOTE : Blocks until a window event arrives, a view is invalidated from a script or the timeout expires.
+    // The timeout keeps jobs and the command track running while nothing is drawn.
+    void waitEvents(double timeout)
+    {
+#ifndef EMSCRIPTEN
+# if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 2)
+        glfwWaitEventsTimeout(timeout);
+# else
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        (void) timeout;
+# endif
+#else
+        // NOTE : The browser drives the main loop
+        (void) timeout;
+#endif
     }
 
     void registerScript(const char* name, const char* source)
@@ -205,9 +308,14 @@ public:
     virtual GraphitiConsole* console() { return m_Console; }
     virtual EntityManager& entities() { return m_EntityManager; }
     virtual EntityVisualizerManager& visualizers() { return m_VisualizerManager; }
+    inline FrameScheduler& scheduler() { return m_Scheduler; }
+
+    double IdleTimeout; // NOTE : In seconds
+    double CommandBudget; // NOTE : In milliseconds, time given to posted commands every main loop iteration
 
 private:
     GraphitiConsole* m_Console;
     EntityManager m_EntityManager;
     EntityVisualizerManager m_VisualizerManager;
+    FrameScheduler m_Scheduler;
 };
\ No newline at end of file
@@ -161,6 +161,7 @@ def load_json(json_filename):
 
     if "timeline" in data:
         print(". Loading timeline ...")
+        commands = list()
         for c in data["timeline"]:
             # TODO : Get rid of this translation phase when possible.
             if c[1].startswith("graph:"):
@@ -171,7 +172,9 @@ def load_json(json_filename):
                 elif c[1] in ["graph:add_link"]:
                     c[2]["src"] = nodes[c[2]["src"]]
                     c[2]["dst"] = nodes[c[2]["dst"]]
-            graphiti.send_command(c[0], c[1], c[2])
+            commands.append((c[0], c[1], c[2]))
+        if graphiti.send_commands(commands) is None:
+            print("Error: Couldn't load the timeline, no command was sent!")
 
     print("Done.")
 
@@ -10,6 +10,8 @@
 #include <raindance/Core/Resources/Texture.hh>
 
 #include "Entities/MVC.hh"
+#include "Core/Uniforms.hh"
+#include "Core/RenderState.hh"
 
 class CloudView : public GraphView
 {
@@ -49,6 +51,13 @@ public:
 		m_MeshMaterial.setDiffuse(glm::vec4(SKY_BLUE, 1.0));
 		m_MeshMaterial.setShininess(45.0f);
 		m_MeshLight.setPosition(glm::vec3(0.0, 10000.0, 0.0));
+
+		m_MeshModel = m_MeshUniforms.declare("u_ModelMatrix");
+		m_MeshNormal = m_MeshUniforms.declare("u_NormalMatrix");
+		m_MeshAmbient = m_MeshUniforms.declare("u_Material.Ambient");
+		m_MeshDiffuse = m_MeshUniforms.declare("u_Material.Diffuse");
+		m_MeshSpecular = m_MeshUniforms.declare("u_Material.Specular");
+		m_MeshShininess = m_MeshUniforms.declare("u_Material.Shininess");
 	}
 
 	virtual ~CloudView()
@@ -92,8 +101,8 @@ public:
 	{
 		glClearColor(0.2, 0.2, 0.2, 1.0);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		glDisable(GL_BLEND);
-		glEnable(GL_DEPTH_TEST);
+		RenderState::getInstance().disable(GL_BLEND);
+		RenderState::getInstance().enable(GL_DEPTH_TEST);
 
 		Transformation transformation;
 
@@ -102,27 +111,25 @@ public:
 
 		transformation.translate(-center);
 
+		m_Frame.update(m_Camera3D.getViewMatrix(), m_Camera3D.getProjectionMatrix(), m_MeshLight);
+
 		m_PointCloud->draw(context(), m_Camera3D.getProjectionMatrix(), m_Camera3D.getViewMatrix(), transformation.state());
+		RenderState::getInstance().invalidate();
 
 		// IsoVolume rendering
 		if (m_Mesh != NULL)
 		{
-			m_MeshShader->use();
+			RenderState::getInstance().use(m_MeshShader);
 			{
-				m_MeshShader->uniform("u_ModelMatrix").set(transformation.state());
-				m_MeshShader->uniform("u_ViewMatrix").set(m_Camera3D.getViewMatrix());
-				m_MeshShader->uniform("u_ProjectionMatrix").set(m_Camera3D.getProjectionMatrix());
-				m_MeshShader->uniform("u_NormalMatrix").set(glm::transpose(glm::inverse(glm::mat3(m_Camera3D.getViewMatrix() * transformation.state()))));
-
-				m_MeshShader->uniform("u_Light.Type").set(m_MeshLight.getType());
-				m_MeshShader->uniform("u_Light.Position").set(m_MeshLight.getPosition());
-				m_MeshShader->uniform("u_Light.Direction").set(m_MeshLight.getDirection());
-				m_MeshShader->uniform("u_Light.Color").set(m_MeshLight.getColor());
-
-				m_MeshShader->uniform("u_Material.Ambient").set(m_MeshMaterial.getAmbient());
-				m_MeshShader->uniform("u_Material.Diffuse").set(m_MeshMaterial.getDiffuse());
-				m_MeshShader->uniform("u_Material.Specular").set(m_MeshMaterial.getSpecular());
-				m_MeshShader->uniform("u_Material.Shininess").set(m_MeshMaterial.getShininess());
+				m_MeshUniforms.bind();
+				m_MeshUniforms.set(m_Frame);
+				m_MeshUniforms.set(m_MeshModel, transformation.state());
+				m_MeshUniforms.set(m_MeshNormal, glm::transpose(glm::inverse(glm::mat3(m_Camera3D.getViewMatrix() * transformation.state()))));
+
+				m_MeshUniforms.set(m_MeshAmbient, m_MeshMaterial.getAmbient());
+				m_MeshUniforms.set(m_MeshDiffuse, m_MeshMaterial.getDiffuse());
+				m_MeshUniforms.set(m_MeshSpecular, m_MeshMaterial.getSpecular());
+				m_MeshUniforms.set(m_MeshShininess, m_MeshMaterial.getShininess());
 			}
 
 			context()->geometry().bind(m_Mesh->getVertexBuffer(), *m_MeshShader);
@@ -138,7 +145,7 @@ public:
 			transformation.scale(glm::vec3(diff.x, diff.y, diff.z));
 			transformation.rotate(90, glm::vec3(1.0, 0.0, 0.0));
 
-			m_SliceShader->use();
+			RenderState::getInstance().use(m_SliceShader);
 			m_SliceShader->uniform("u_ModelViewProjectionMatrix").set(m_Camera3D.getViewProjectionMatrix() * transformation.state());
 			// m_SliceShader->uniform("u_NormalMatrix").set(glm::transpose(glm::inverse(glm::mat3(m_Camera3D.getViewMatrix() * transformation.state()))));
 			m_SliceShader->uniform("u_Texture").set(*m_SliceTexture);
@@ -178,6 +185,8 @@ public:
 			transformation.pop();
 		}
 		transformation.pop();
+
+		RenderState::getInstance().invalidate();
 	}
 
 	virtual void idle()
@@ -420,8 +429,16 @@ private:
 
 	Mesh* m_Mesh;
 	Shader::Program* m_MeshShader;
+	UniformCache m_MeshUniforms;
+	UniformCache::Handle m_MeshModel;
+	UniformCache::Handle m_MeshNormal;
+	UniformCache::Handle m_MeshAmbient;
+	UniformCache::Handle m_MeshDiffuse;
+	UniformCache::Handle m_MeshSpecular;
+	UniformCache::Handle m_MeshShininess;
 	Material m_MeshMaterial;
 	Light m_MeshLight;
+	FrameUniforms m_Frame;
 
 	Texture* m_SliceTexture;
 	Quad* m_SliceQuad;
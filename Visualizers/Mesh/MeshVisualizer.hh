@@ -36,6 +36,7 @@ public:
 
         set(view);
         set(controller);
+        listen(entity, view);
 
         return true;
     }
@@ -8,6 +8,8 @@
 
 #include "Entities/Graph/GraphModel.hh"
 
+#include "Core/RenderState.hh"
+
 class ParticleView : public GraphView
 {
 public:
@@ -107,10 +109,10 @@ public:
         glClearColor(0.2, 0.2, 0.2, 1.0);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        glEnable(GL_DEPTH_TEST);
-        glDisable(GL_BLEND);
+        RenderState::getInstance().enable(GL_DEPTH_TEST);
+        RenderState::getInstance().disable(GL_BLEND);
 
-        m_Shader->use();
+        RenderState::getInstance().use(m_Shader);
 
         glm::mat4 model;
 
@@ -173,6 +175,10 @@ public:
     }
 
     virtual void idle()
+    {
+    }
+
+    virtual void step()
     {
         if (m_Physics)
         {
@@ -361,8 +367,8 @@ private:
 
     std::vector<ParticleNode> m_Nodes;
     std::vector<ParticleEdge> m_Edges;
-    TranslationMap<ParticleNode::ID, Node::ID> m_NodeMap;
-    TranslationMap<ParticleEdge::ID, Link::ID> m_EdgeMap;
+    DenseTranslationMap<ParticleNode::ID, Node::ID> m_NodeMap;
+    DenseTranslationMap<ParticleEdge::ID, Link::ID> m_EdgeMap;
 
     OpenCL m_OpenCL;
     OpenCL::Context* m_Context;
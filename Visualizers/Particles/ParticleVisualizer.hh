@@ -35,6 +35,7 @@ public:
 
         set(view);
         set(controller);
+        listen(entity, view);
 
         return true;
     }
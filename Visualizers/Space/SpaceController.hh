@@ -26,6 +26,7 @@ public:
 
 		m_ToolMode = POINTER;
 		m_HasSelection = false;
+		m_SelectedUID = 0;
 		m_HasTarget = false;
 		m_HasPick = false;
 		m_IsDragging = false;
@@ -78,14 +79,19 @@ public:
 
 	void updateSelection()
 	{
-		// NOTE : Has selected node been removed ?
-		if (m_HasSelection && !m_GraphView->getNodeMap().containsLocalID(m_SelectedNode))
+		if (!m_HasSelection)
+			return;
+
+		// NOTE : Has selected node been removed ? Local IDs also change when the view is compacted.
+		if (!m_GraphView->getNodeMap().containsRemoteID(m_SelectedUID))
 		{
 			m_HasSelection = false;
 			m_IsDragging = false;
 			m_HasTarget = false;
 			m_HasPick = false;
 		}
+		else
+			m_SelectedNode = m_GraphView->getNodeMap().getLocalID(m_SelectedUID);
 	}
 
 	void onWindowSize(int width, int height) override
@@ -188,6 +194,7 @@ public:
 					m_GraphModel->selectNode(m_GraphView->getNodeMap().getRemoteID(m_PickNode));
 					m_HasSelection = true;
 					m_SelectedNode = m_PickNode;
+					m_SelectedUID = m_GraphView->getNodeMap().getRemoteID(m_PickNode);
 				}
 				else if (m_ToolMode == MARKER)
 				{
@@ -223,7 +230,7 @@ public:
 		if (m_HasSelection)
 		{
 			m_HasTarget = true;
-			m_GraphContext->messages().push(new GraphTargetNodeMessage(m_SelectedNode));
+			m_GraphContext->messages().push(new GraphTargetNodeMessage(m_SelectedUID));
 
 			m_SphericalCameraController.onMouseDoubleClick(pos);
 		}
@@ -253,8 +260,7 @@ public:
 		float length = glm::length(direction);
 
 		m_GraphView->getNodes()[m_SelectedNode]->setPosition(ray.position() + length * ray.direction());
-
-		// NOTE : I don't think we need to force octree update here since we can only drag nodes within the vision field.
+		m_GraphView->updateNode(m_SelectedNode);
 	}
 
 	void notify(IMessage* message) override
@@ -264,7 +270,11 @@ public:
 		{
 			GraphTargetNodeMessage* msg = static_cast<GraphTargetNodeMessage*>(message);
 
-			Scene::Node* node = m_GraphView->getNodes()[msg->ID];
+			// NOTE : The node may have been removed since the message was pushed
+			if (!m_GraphView->getNodeMap().containsRemoteID(msg->ID))
+				return;
+
+			Scene::Node* node = m_GraphView->getNodes()[m_GraphView->getNodeMap().getLocalID(msg->ID)];
 
 			// NOTE : Calculate the zoom distance according to the node size so that it always has the same screen size.
 			float zoomAngle = M_PI / 20;
@@ -446,6 +456,7 @@ private:
 	bool m_IsDragging;
 	SpaceNode::ID m_PickNode;
 	SpaceNode::ID m_SelectedNode;
+	Node::ID m_SelectedUID;
 
 	DemoMode m_DemoMode;
 };
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "Core/DynamicBuffer.hh"
+#include "Core/RenderTarget.hh"
+
+#include "Visualizers/Space/SpaceResources.hh"
+
+// NOTE : Density rendering mode. Every node is splatted once, additively, as a gaussian point into a
+// float buffer, which is then mapped to colors with a single full-screen pass.
+class SpaceDensity
+{
+public:
+    typedef unsigned long ID;
+
+    struct Vertex
+    {
+        glm::vec3 Position;
+        float LOD;
+        float Weight; // NOTE : 0 when the slot is unused
+    };
+
+    SpaceDensity()
+    : m_Points(sizeof(Vertex), 1), m_Quad(sizeof(glm::vec2), 4),
+    #ifdef EMSCRIPTEN
+      m_Target(GL_RGBA, GL_FLOAT),
+    #else
+      m_Target(GL_RGBA16F, GL_FLOAT),
+    #endif
+      m_FallbackTarget(GL_RGBA, GL_UNSIGNED_BYTE)
+    {
+        m_Points.describe("a_Position", 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, Position));
+        m_Points.describe("a_LOD",      1, GL_FLOAT, GL_FALSE, offsetof(Vertex, LOD));
+        m_Points.describe("a_Weight",   1, GL_FLOAT, GL_FALSE, offsetof(Vertex, Weight));
+
+        m_Quad.describe("a_Position", 2, GL_FLOAT, GL_FALSE, 0);
+        glm::vec2* quad = m_Quad.vertices<glm::vec2>(m_Quad.allocate());
+        quad[0] = glm::vec2(-1, -1);
+        quad[1] = glm::vec2( 1, -1);
+        quad[2] = glm::vec2(-1,  1);
+        quad[3] = glm::vec2( 1,  1);
+
+        KernelSize = 8.0f;
+        Range = 64.0f;
+        m_UseFallback = false;
+    }
+
+    virtual ~SpaceDensity()
+    {
+    }
+
+    void update(ID id, const glm::vec3& position, float lod)
+    {
+        if (id >= m_Slots.size())
+            m_Slots.resize(id + 1, DynamicBuffer::InvalidSlot);
+
+        if (m_Slots[id] == DynamicBuffer::InvalidSlot)
+            m_Slots[id] = m_Points.allocate();
+
+        Vertex* vertex = m_Points.vertices<Vertex>(m_Slots[id]);
+        vertex->Position = position;
+        vertex->LOD = lod;
+        vertex->Weight = 1.0f;
+
+        m_Points.touch(m_Slots[id]);
+    }
+
+    void remove(ID id)
+    {
+        if (id >= m_Slots.size() || m_Slots[id] == DynamicBuffer::InvalidSlot)
+            return;
+
+        Vertex* vertex = m_Points.vertices<Vertex>(m_Slots[id]);
+        vertex->Weight = 0.0f;
+
+        m_Points.release(m_Slots[id]);
+        m_Slots[id] = DynamicBuffer::InvalidSlot;
+    }
+
+    void clear()
+    {
+        for (ID id = 0; id < m_Slots.size(); id++)
+            remove(id);
+    }
+
+    void draw(Camera& camera, const glm::vec2& viewport, const glm::mat4& model)
+    {
+        if (m_Points.count() == 0)
+            return;
+
+        RenderTarget* target = m_UseFallback ? &m_FallbackTarget : &m_Target;
+        if (!target->resize(static_cast<int>(viewport.x), static_cast<int>(viewport.y)))
+        {
+            if (m_UseFallback)
+                return;
+
+            LOG("[SPACE] Float render targets are not supported, density will saturate.\n");
+            m_UseFallback = true;
+            return;
+        }
+
+        m_Points.upload();
+        m_Quad.upload();
+
+        // Splat pass
+
+        target->bind();
+
+        glClearColor(0, 0, 0, 0);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        RenderState::getInstance().disable(GL_DEPTH_TEST);
+        RenderState::getInstance().enable(GL_BLEND);
+        RenderState::getInstance().blendFunc(GL_ONE, GL_ONE);
+        #ifndef EMSCRIPTEN
+            // NOTE : Always enabled in WebGL
+            RenderState::getInstance().enable(GL_VERTEX_PROGRAM_POINT_SIZE);
+            #ifdef GL_POINT_SPRITE
+                RenderState::getInstance().enable(GL_POINT_SPRITE);
+            #endif
+        #endif
+
+        Shader::Program* shader = g_SpaceResources->DensityShader;
+        RenderState::getInstance().use(shader);
+        shader->uniform("u_ModelViewProjection").set(camera.getViewProjectionMatrix() * model);
+        shader->uniform("u_KernelSize").set(KernelSize);
+        shader->uniform("u_LOD").set(glm::vec3(g_SpaceResources->ShowNodeLOD ? 1.0 : 0.0, g_SpaceResources->LODSlice[0], g_SpaceResources->LODSlice[1]));
+
+        m_Points.bind();
+        glDrawArrays(GL_POINTS, 0, m_Points.count());
+        Stats::getInstance().drawCall(m_Points.count());
+        m_Points.unbind();
+
+        target->unbind();
+
+        // Colormap pass
+
+        RenderState::getInstance().blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, target->getColorTexture());
+
+        shader = g_SpaceResources->ColormapShader;
+        RenderState::getInstance().use(shader);
+        shader->uniform("u_Range").set(Range);
+
+        m_Quad.bind();
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        Stats::getInstance().drawCall(2);
+        m_Quad.unbind();
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        RenderState::getInstance().blendFunc(GL_SRC_ALPHA, GL_DST_ALPHA);
+    }
+
+    float KernelSize; // NOTE : Diameter of the gaussian splat, in pixels
+    float Range; // NOTE : Density mapped to the top of the colormap
+
+private:
+    DynamicBuffer m_Points;
+    DynamicBuffer m_Quad;
+    std::vector<DynamicBuffer::Slot> m_Slots;
+
+    RenderTarget m_Target;
+    RenderTarget m_FallbackTarget;
+    bool m_UseFallback;
+};
@@ -0,0 +1,354 @@
+#pragma once
+
+#include "Core/DynamicBuffer.hh"
+
+#include <cstring>
+#include <unordered_map>
+
+#include "Visualizers/Space/SpaceResources.hh"
+
+// NOTE : Every space edge lives in one slot of a shared vertex buffer so that all the edges
+// are drawn with a single call per edge style.
+class SpaceEdgeBatch
+{
+public:
+    typedef DynamicBuffer::Slot Slot;
+
+    static const Slot InvalidSlot = DynamicBuffer::InvalidSlot;
+
+    struct Vertex
+    {
+        glm::vec3 Start;
+        glm::vec3 End;
+        glm::vec2 Corner; // NOTE : Position along the edge (0 or 1), side of the extrusion (-1 or 1)
+        unsigned char Color1[4];
+        unsigned char Color2[4];
+        glm::vec4 Params; // NOTE : Width, LOD, Style (-1 when the slot is unused), Activity
+    };
+
+    SpaceEdgeBatch()
+    : m_Buffer(sizeof(Vertex), 4)
+    {
+        m_Buffer.describe("a_Start",  3, GL_FLOAT,         GL_FALSE, offsetof(Vertex, Start));
+        m_Buffer.describe("a_End",    3, GL_FLOAT,         GL_FALSE, offsetof(Vertex, End));
+        m_Buffer.describe("a_Corner", 2, GL_FLOAT,         GL_FALSE, offsetof(Vertex, Corner));
+        m_Buffer.describe("a_Color1", 4, GL_UNSIGNED_BYTE, GL_TRUE,  offsetof(Vertex, Color1));
+        m_Buffer.describe("a_Color2", 4, GL_UNSIGNED_BYTE, GL_TRUE,  offsetof(Vertex, Color2));
+        m_Buffer.describe("a_Params", 4, GL_FLOAT,         GL_FALSE, offsetof(Vertex, Params));
+
+        m_TriangleIBO = 0;
+        m_LineIBO = 0;
+        m_IndexCapacity = 0;
+        m_UintIndices = true;
+
+        m_ActiveCount = 0;
+        m_Declared = false;
+    }
+
+    virtual ~SpaceEdgeBatch()
+    {
+        if (m_TriangleIBO != 0)
+            glDeleteBuffers(1, &m_TriangleIBO);
+        if (m_LineIBO != 0)
+            glDeleteBuffers(1, &m_LineIBO);
+    }
+
+    Slot allocate()
+    {
+        Slot slot = m_Buffer.allocate();
+
+        Vertex* vertices = m_Buffer.vertices<Vertex>(slot);
+        for (unsigned int i = 0; i < 4; i++)
+        {
+            vertices[i].Corner = glm::vec2((float) (i / 2), i % 2 == 0 ? -1.0f : 1.0f);
+            vertices[i].Params = glm::vec4(0.0, 0.0, -1.0, 0.0);
+        }
+
+        return slot;
+    }
+
+    void release(Slot slot)
+    {
+        Vertex* vertices = m_Buffer.vertices<Vertex>(slot);
+        countStyle(vertices[0].Params[2], -1);
+        countActivity(vertices[0].Params[3], 0.0f);
+
+        for (unsigned int i = 0; i < 4; i++)
+            vertices[i].Params = glm::vec4(0.0, 0.0, -1.0, 0.0);
+
+        m_Buffer.release(slot);
+    }
+
+    // NOTE : A negative style hides the edge
+    void set(Slot slot, const glm::vec3 positions[2], const glm::vec4 colors[2], float width, float lod, int style, float activity)
+    {
+        Vertex* vertices = m_Buffer.vertices<Vertex>(slot);
+
+        countStyle(vertices[0].Params[2], -1);
+        countStyle((float) style, +1);
+        countActivity(vertices[0].Params[3], activity);
+
+        unsigned char color1[4];
+        unsigned char color2[4];
+        for (unsigned int c = 0; c < 4; c++)
+        {
+            color1[c] = (unsigned char) (255.0f * glm::clamp(colors[0][c], 0.0f, 1.0f));
+            color2[c] = (unsigned char) (255.0f * glm::clamp(colors[1][c], 0.0f, 1.0f));
+        }
+
+        for (unsigned int i = 0; i < 4; i++)
+        {
+            vertices[i].Start = positions[0];
+            vertices[i].End = positions[1];
+            memcpy(vertices[i].Color1, color1, 4);
+            memcpy(vertices[i].Color2, color2, 4);
+            vertices[i].Params = glm::vec4(width, lod, style < 0 ? -1.0f : (float) style, activity);
+        }
+
+        m_Buffer.touch(slot);
+    }
+
+    // NOTE : Extrusion and activity are computed in the vertex shader, the CPU cost of a frame doesn't depend on the number of edges.
+    // The camera comes from the shared frame uniforms.
+    void draw(Context* context, const glm::mat4& modelViewProjection)
+    {
+        bool showEdges = g_SpaceResources->ShowEdges && g_SpaceResources->m_EdgeMode != SpaceResources::OFF;
+        bool showActivity = g_SpaceResources->ShowEdgeActivity && m_ActiveCount > 0;
+
+        if (m_Buffer.count() == 0 || (!showEdges && !showActivity))
+            return;
+
+        m_Buffer.upload();
+        updateIndices();
+
+        Shader::Program* shader = g_SpaceResources->EdgeShader;
+        UniformCache& uniforms = g_SpaceResources->EdgeUniforms;
+        declare(uniforms);
+
+        RenderState::getInstance().use(shader);
+        uniforms.bind();
+        uniforms.set(g_SpaceResources->Frame);
+        uniforms.set(m_ModelViewProjection, modelViewProjection);
+        uniforms.set(m_EdgeSize, g_SpaceResources->EdgeSize);
+        uniforms.set(m_Time, (float) context->clock().seconds());
+        uniforms.set(m_LOD, glm::vec3(g_SpaceResources->ShowEdgeLOD ? 1.0 : 0.0, g_SpaceResources->LODSlice[0], g_SpaceResources->LODSlice[1]));
+
+        m_Buffer.bind();
+
+        if (showEdges && g_SpaceResources->m_EdgeMode == SpaceResources::LINES)
+        {
+            // NOTE : Line width can't vary per edge anymore, all lines share the global edge size.
+            RenderState::getInstance().lineWidth(g_SpaceResources->EdgeSize);
+
+            uniforms.set(m_Mode, 0.0f);
+            uniforms.set(m_Style, 0.0f);
+
+            drawSlots(GL_LINES, m_LineIBO, 2);
+            Stats::getInstance().drawCall(m_Buffer.count());
+
+            RenderState::getInstance().lineWidth(1.0);
+        }
+        else if (showEdges && g_SpaceResources->m_EdgeMode == SpaceResources::WIDE_LINES)
+        {
+            uniforms.set(m_Mode, 1.0f);
+
+            for (unsigned int style = 0; style < m_StyleCounts.size(); style++)
+            {
+                if (m_StyleCounts[style] == 0)
+                    continue;
+
+                uniforms.set(m_Style, (float) style);
+                uniforms.set(m_Texture, textureName(shader, uniforms, g_SpaceResources->EdgeStyleIcon->getTexture(style)), 0);
+                drawSlots(GL_TRIANGLES, m_TriangleIBO, 6);
+                Stats::getInstance().drawCall(2 * m_Buffer.count());
+            }
+        }
+
+        if (showActivity)
+        {
+            uniforms.set(m_Mode, 2.0f);
+            uniforms.set(m_Style, 0.0f);
+            uniforms.set(m_Texture, textureName(shader, uniforms, g_SpaceResources->EdgeActivityIcon->getTexture(0)), 0);
+
+            drawSlots(GL_TRIANGLES, m_TriangleIBO, 6);
+            Stats::getInstance().drawCall(2 * m_Buffer.count());
+        }
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        m_Buffer.unbind();
+    }
+
+    inline unsigned long count() const { return m_Buffer.count(); }
+    inline bool hasActivity() const { return m_ActiveCount > 0; }
+
+private:
+    void declare(UniformCache& uniforms)
+    {
+        if (m_Declared)
+            return;
+
+        m_ModelViewProjection = uniforms.declare("u_ModelViewProjection");
+        m_EdgeSize = uniforms.declare("u_EdgeSize");
+        m_Time = uniforms.declare("u_Time");
+        m_LOD = uniforms.declare("u_LOD");
+        m_Mode = uniforms.declare("u_Mode");
+        m_Style = uniforms.declare("u_Style");
+        m_Texture = uniforms.declare("u_Texture");
+        m_Declared = true;
+    }
+
+    // NOTE : GL name of an icon texture. The engine binds textures through its own uniforms only, each name is
+    // read back the first time the texture is used, then the texture is bound through the cache.
+    template<typename T>
+    GLuint textureName(Shader::Program* shader, UniformCache& uniforms, T& texture)
+    {
+        auto it = m_TextureNames.find(&texture);
+        if (it != m_TextureNames.end())
+            return it->second;
+
+        glActiveTexture(GL_TEXTURE0);
+        shader->uniform("u_Texture").set(texture);
+        uniforms.forget(m_Texture);
+
+        GLint name = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &name);
+        m_TextureNames[&texture] = name;
+        return name;
+    }
+
+    void countStyle(float style, int delta)
+    {
+        if (style < 0.0f)
+            return;
+
+        unsigned int index = static_cast<unsigned int>(style);
+        if (index >= m_StyleCounts.size())
+            m_StyleCounts.resize(index + 1, 0);
+        m_StyleCounts[index] += delta;
+    }
+
+    void countActivity(float previous, float current)
+    {
+        if (previous > 0.0f)
+            m_ActiveCount--;
+        if (current > 0.0f)
+            m_ActiveCount++;
+    }
+
+    // NOTE : 32-bit indices are core on desktop GL, WebGL and GLES 2 need the OES_element_index_uint extension
+    static bool hasUintIndices()
+    {
+#if defined(EMSCRIPTEN) || defined(GL_ES_VERSION_2_0)
+        static int s_Supported = -1;
+        if (s_Supported < 0)
+        {
+            const char* extensions = reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+            s_Supported = extensions != NULL && strstr(extensions, "OES_element_index_uint") != NULL ? 1 : 0;
+        }
+        return s_Supported == 1;
+#else
+        return true;
+#endif
+    }
+
+    // NOTE : Draws the used slots with one of the index patterns. With 16-bit indices the pattern only spans
+    // c_ShortSlots slots, larger buffers are drawn in several calls, each one binding the attributes from the
+    // first vertex of its range.
+    void drawSlots(GLenum mode, GLuint ibo, unsigned int indices)
+    {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+
+        if (m_UintIndices)
+        {
+            glDrawElements(mode, indices * m_Buffer.count(), GL_UNSIGNED_INT, 0);
+            return;
+        }
+
+        for (unsigned long first = 0; first < m_Buffer.count(); first += c_ShortSlots)
+        {
+            unsigned long count = m_Buffer.count() - first;
+            if (count > c_ShortSlots)
+                count = c_ShortSlots;
+
+            m_Buffer.bind(4 * first);
+            glDrawElements(mode, indices * count, GL_UNSIGNED_SHORT, 0);
+        }
+    }
+
+    // NOTE : Index patterns only depend on the slot capacity, they are rebuilt when the buffer grows.
+    void updateIndices()
+    {
+        m_UintIndices = hasUintIndices();
+
+        unsigned long capacity = m_Buffer.capacity();
+        if (!m_UintIndices && capacity > c_ShortSlots)
+            capacity = c_ShortSlots;
+
+        if (m_IndexCapacity == capacity)
+            return;
+
+        m_IndexCapacity = capacity;
+
+        if (m_UintIndices)
+            uploadIndices<GLuint>();
+        else
+            uploadIndices<GLushort>();
+    }
+
+    template<typename Index>
+    void uploadIndices()
+    {
+        std::vector<Index> triangles;
+        std::vector<Index> lines;
+        triangles.reserve(6 * m_IndexCapacity);
+        lines.reserve(2 * m_IndexCapacity);
+
+        for (unsigned long slot = 0; slot < m_IndexCapacity; slot++)
+        {
+            Index base = static_cast<Index>(4 * slot);
+
+            triangles.push_back(base + 0);
+            triangles.push_back(base + 1);
+            triangles.push_back(base + 2);
+            triangles.push_back(base + 2);
+            triangles.push_back(base + 1);
+            triangles.push_back(base + 3);
+
+            lines.push_back(base + 0);
+            lines.push_back(base + 2);
+        }
+
+        if (m_TriangleIBO == 0)
+            glGenBuffers(1, &m_TriangleIBO);
+        if (m_LineIBO == 0)
+            glGenBuffers(1, &m_LineIBO);
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_TriangleIBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, triangles.size() * sizeof(Index), triangles.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_LineIBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, lines.size() * sizeof(Index), lines.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+
+    // NOTE : 4 vertices per slot, the most a 16-bit index can address
+    static const unsigned long c_ShortSlots = 16384;
+
+    DynamicBuffer m_Buffer;
+    std::vector<unsigned long> m_StyleCounts;
+    unsigned long m_ActiveCount;
+
+    bool m_Declared;
+    UniformCache::Handle m_ModelViewProjection;
+    UniformCache::Handle m_EdgeSize;
+    UniformCache::Handle m_Time;
+    UniformCache::Handle m_LOD;
+    UniformCache::Handle m_Mode;
+    UniformCache::Handle m_Style;
+    UniformCache::Handle m_Texture;
+    std::unordered_map<const void*, GLuint> m_TextureNames;
+
+    GLuint m_TriangleIBO;
+    GLuint m_LineIBO;
+    unsigned long m_IndexCapacity;
+    bool m_UintIndices;
+};
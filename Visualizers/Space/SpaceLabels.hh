@@ -0,0 +1,117 @@
+#pragma once
+
+#include <raindance/Core/Camera/Camera.hh>
+#include <raindance/Core/Scene/NodeVector.hh>
+
+#include "Visualizers/Space/SpaceNode.hh"
+#include "Visualizers/Space/SpaceOctree.hh"
+
+// NOTE : Screen-space label pass. Labels are only drawn when their node is large enough on screen
+// to be readable, and when they don't overlap a label that has already been placed this frame.
+// Only the nodes that passed the octree frustum traversal of the node pass are considered.
+class SpaceLabels
+{
+public:
+    struct Candidate
+    {
+        SpaceNode* Node;
+        glm::vec2 Screen;
+        float Size;
+
+        bool operator<(const Candidate& other) const { return Size > other.Size; }
+    };
+
+    SpaceLabels()
+    {
+        MinimumSize = 8.0f;
+        CellSize = 16.0f;
+        m_DrawCount = 0;
+    }
+
+    virtual ~SpaceLabels()
+    {
+    }
+
+    void draw(Context* context, Scene::NodeVector& nodes, const std::vector<SpaceOctree::ID>& visible, Camera& camera, const glm::vec2& viewport, const glm::mat4& model)
+    {
+        const float c_LabelRatio = 0.66f;
+        const float c_CharacterRatio = 0.6f; // NOTE : Average glyph width relative to the label height
+
+        glm::mat4 viewProjection = camera.getViewProjectionMatrix() * model;
+        float pixelScale = 0.5f * viewport.y * camera.getProjectionMatrix()[1][1];
+
+        // Projection & minimum size culling
+
+        m_Candidates.clear();
+
+        for (auto id : visible)
+        {
+            SpaceNode* node = static_cast<SpaceNode*>(nodes[id]);
+            if (node->getLabel().empty() || !g_SpaceResources->isNodeVisible(node->getLOD()))
+                continue;
+
+            glm::vec4 clip = viewProjection * glm::vec4(node->getPosition(), 1.0);
+            if (clip.w <= 0.0f)
+                continue;
+
+            glm::vec3 ndc = glm::vec3(clip) / clip.w;
+            if (ndc.x < -1.0f || ndc.x > 1.0f || ndc.y < -1.0f || ndc.y > 1.0f)
+                continue;
+
+            Candidate candidate;
+            candidate.Node = node;
+            candidate.Size = node->getScreenSize() * pixelScale / clip.w;
+            if (candidate.Size * c_LabelRatio < MinimumSize)
+                continue;
+
+            candidate.Screen = glm::vec2(0.5f * (ndc.x + 1.0f) * viewport.x, 0.5f * (ndc.y + 1.0f) * viewport.y);
+            m_Candidates.push_back(candidate);
+        }
+
+        // Collision culling, closest labels first
+
+        std::sort(m_Candidates.begin(), m_Candidates.end());
+
+        int columns = static_cast<int>(ceil(viewport.x / CellSize));
+        int rows = static_cast<int>(ceil(viewport.y / CellSize));
+        m_Grid.assign(columns * rows, false);
+
+        m_DrawCount = 0;
+
+        for (auto& candidate : m_Candidates)
+        {
+            float height = c_LabelRatio * candidate.Size;
+            float width = c_CharacterRatio * height * candidate.Node->getLabel().size();
+
+            int x0 = glm::clamp(static_cast<int>((candidate.Screen.x + candidate.Size / 2) / CellSize), 0, columns - 1);
+            int x1 = glm::clamp(static_cast<int>((candidate.Screen.x + candidate.Size / 2 + width) / CellSize), 0, columns - 1);
+            int y0 = glm::clamp(static_cast<int>((candidate.Screen.y - height / 2) / CellSize), 0, rows - 1);
+            int y1 = glm::clamp(static_cast<int>((candidate.Screen.y + height / 2) / CellSize), 0, rows - 1);
+
+            bool overlap = false;
+            for (int y = y0; y <= y1 && !overlap; y++)
+                for (int x = x0; x <= x1 && !overlap; x++)
+                    overlap = m_Grid[y * columns + x];
+
+            if (overlap)
+                continue;
+
+            for (int y = y0; y <= y1; y++)
+                for (int x = x0; x <= x1; x++)
+                    m_Grid[y * columns + x] = true;
+
+            candidate.Node->drawLabel(context, camera.getProjectionMatrix(), camera.getViewMatrix(), model);
+            m_DrawCount++;
+        }
+    }
+
+    inline unsigned long getDrawCount() const { return m_DrawCount; }
+
+    float MinimumSize; // NOTE : In pixels
+    float CellSize; // NOTE : In pixels
+
+private:
+    std::vector<Candidate> m_Candidates;
+    std::vector<bool> m_Grid;
+    unsigned long m_DrawCount;
+};
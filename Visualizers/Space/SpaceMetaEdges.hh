@@ -0,0 +1,252 @@
+#pragma once
+
+#include <raindance/Core/Scene/NodeVector.hh>
+
+#include "Visualizers/Space/SpaceOctree.hh"
+#include "Visualizers/Space/SpaceEdgeBatch.hh"
+#include "Visualizers/Space/SpaceEdge.hh"
+
+// NOTE : Edge aggregation for the automatic LOD. Edges with at least one endpoint inside a collapsed
+// octree cell are hidden and merged with the other edges joining the same pair of endpoints.
+// Endpoints are either a node (ID >= 0) or a collapsed cell (-1 - cell).
+class SpaceMetaEdges
+{
+public:
+    typedef std::pair<long, long> Key;
+
+    struct MetaEdge
+    {
+        unsigned long Count;
+        SpaceEdgeBatch::Slot Slot;
+    };
+
+    SpaceMetaEdges()
+    {
+        WidthPerEdge = 0.25f;
+        MaxWidth = 8.0f;
+        m_Active = false;
+    }
+
+    virtual ~SpaceMetaEdges()
+    {
+    }
+
+    // NOTE : Only the edges of the nodes that changed cell in the octree (see SpaceOctree::changed), or that
+    // sit in a cell collapsed or expanded since the last call, are reassigned. The caller clears the octree
+    // changes once they're consumed.
+    void update(const SpaceOctree& octree, const std::vector<long>& collapsed, Scene::NodeVector& edges, const std::vector< std::vector<SpaceEdge::ID> >& nodeEdges)
+    {
+        std::vector<long> cut = collapsed;
+        std::sort(cut.begin(), cut.end());
+
+        if (!m_Active)
+        {
+            m_Collapsed.swap(cut);
+            m_Active = true;
+
+            for (SpaceEdge::ID id = 0; id < edges.size(); id++)
+                if (edges[id] != NULL)
+                    assign(octree, edges, id);
+            return;
+        }
+
+        NodeCollector collector;
+        collector.Nodes = octree.changed();
+
+        if (cut != m_Collapsed)
+        {
+            std::vector<long> changes;
+            std::set_symmetric_difference(m_Collapsed.begin(), m_Collapsed.end(), cut.begin(), cut.end(), std::back_inserter(changes));
+
+            m_Collapsed.swap(cut);
+
+            for (auto cell : changes)
+                octree.foreachElementsInCell(cell, &collector);
+        }
+
+        for (auto node : collector.Nodes)
+        {
+            if (node >= nodeEdges.size())
+                continue;
+            for (auto id : nodeEdges[node])
+                if (id < edges.size() && edges[id] != NULL)
+                    assign(octree, edges, id);
+        }
+    }
+
+    // NOTE : Called when the automatic LOD is turned off, all the merged edges become visible again.
+    void reset(Scene::NodeVector& edges)
+    {
+        if (!m_Active)
+            return;
+
+        for (SpaceEdge::ID id = 0; id < m_EdgeKeys.size(); id++)
+        {
+            if (!m_EdgeKeys[id].Merged)
+                continue;
+
+            m_EdgeKeys[id].Merged = false;
+            if (id < edges.size() && edges[id] != NULL)
+            {
+                static_cast<SpaceEdge*>(edges[id])->setVisible(true);
+                static_cast<SpaceEdge*>(edges[id])->update();
+            }
+        }
+
+        for (auto& it : m_MetaEdges)
+            m_Batch.release(it.second.Slot);
+        m_MetaEdges.clear();
+
+        m_EdgeKeys.clear();
+        m_Collapsed.clear();
+        m_Active = false;
+    }
+
+    void onAddEdge(const SpaceOctree& octree, Scene::NodeVector& edges, SpaceEdge::ID id)
+    {
+        if (m_Active)
+            assign(octree, edges, id);
+    }
+
+    void onRemoveEdge(SpaceEdge::ID id)
+    {
+        if (id < m_EdgeKeys.size() && m_EdgeKeys[id].Merged)
+        {
+            unmerge(m_EdgeKeys[id].Endpoints);
+            m_EdgeKeys[id].Merged = false;
+        }
+    }
+
+    void draw(Context* context, const SpaceOctree& octree, Scene::NodeVector& nodes, const glm::mat4& modelViewProjection)
+    {
+        if (!m_Active || m_MetaEdges.empty())
+            return;
+
+        // NOTE : Cluster centroids move with their nodes, meta edges are refreshed every frame.
+        for (auto& it : m_MetaEdges)
+        {
+            glm::vec3 positions[2];
+            glm::vec4 colors[2];
+
+            endpoint(octree, nodes, it.first.first, &positions[0], &colors[0]);
+            endpoint(octree, nodes, it.first.second, &positions[1], &colors[1]);
+
+            float width = std::min(MaxWidth, WidthPerEdge * it.second.Count);
+
+            // NOTE : Edges inside a single cluster are merged but not drawn
+            int style = it.first.first == it.first.second ? -1 : 0;
+
+            m_Batch.set(it.second.Slot, positions, colors, width, 0.0f, style, 0.0f);
+        }
+
+        m_Batch.draw(context, modelViewProjection);
+    }
+
+    inline unsigned long count() const { return m_MetaEdges.size(); }
+    inline bool isActive() const { return m_Active; }
+
+    float WidthPerEdge;
+    float MaxWidth;
+
+private:
+    struct EdgeKey
+    {
+        EdgeKey() : Merged(false) {}
+
+        Key Endpoints;
+        bool Merged;
+    };
+
+    class NodeCollector : public SpaceOctree::Functor
+    {
+    public:
+        virtual void apply(SpaceOctree::ID id) { Nodes.push_back(id); }
+        std::vector<SpaceOctree::ID> Nodes;
+    };
+
+    long representative(const SpaceOctree& octree, SpaceNode::ID node) const
+    {
+        long found = -1;
+        for (long cell = octree.getCell(node); cell >= 0; cell = octree.getParent(cell))
+            if (std::binary_search(m_Collapsed.begin(), m_Collapsed.end(), cell))
+                found = cell;
+
+        return found >= 0 ? -1 - found : static_cast<long>(node);
+    }
+
+    void assign(const SpaceOctree& octree, Scene::NodeVector& edges, SpaceEdge::ID id)
+    {
+        if (id >= m_EdgeKeys.size())
+            m_EdgeKeys.resize(id + 1);
+
+        SpaceEdge* edge = static_cast<SpaceEdge*>(edges[id]);
+
+        long a = representative(octree, edge->getNode1());
+        long b = representative(octree, edge->getNode2());
+        Key key = a < b ? Key(a, b) : Key(b, a);
+        bool merged = a < 0 || b < 0;
+
+        EdgeKey& current = m_EdgeKeys[id];
+        if (current.Merged == merged && (!merged || current.Endpoints == key))
+            return;
+
+        if (current.Merged)
+            unmerge(current.Endpoints);
+        if (merged)
+            merge(key);
+
+        current.Endpoints = key;
+        current.Merged = merged;
+
+        edge->setVisible(!merged);
+        edge->update();
+    }
+
+    void merge(const Key& key)
+    {
+        auto it = m_MetaEdges.find(key);
+        if (it == m_MetaEdges.end())
+        {
+            MetaEdge meta;
+            meta.Count = 0;
+            meta.Slot = m_Batch.allocate();
+            it = m_MetaEdges.insert(std::make_pair(key, meta)).first;
+        }
+        it->second.Count++;
+    }
+
+    void unmerge(const Key& key)
+    {
+        auto it = m_MetaEdges.find(key);
+        if (it == m_MetaEdges.end())
+            return;
+
+        if (--it->second.Count == 0)
+        {
+            m_Batch.release(it->second.Slot);
+            m_MetaEdges.erase(it);
+        }
+    }
+
+    void endpoint(const SpaceOctree& octree, Scene::NodeVector& nodes, long representative, glm::vec3* position, glm::vec4* color) const
+    {
+        if (representative >= 0)
+        {
+            SpaceNode* node = static_cast<SpaceNode*>(nodes[representative]);
+            *position = node->getPosition();
+            *color = node->getColor();
+        }
+        else
+        {
+            SpaceOctree::Cluster cluster = octree.getCluster(-1 - representative);
+            *position = cluster.Center;
+            *color = cluster.Color;
+        }
+    }
+
+    SpaceEdgeBatch m_Batch;
+    std::map<Key, MetaEdge> m_MetaEdges;
+    std::vector<EdgeKey> m_EdgeKeys;
+    std::vector<long> m_Collapsed;
+    bool m_Active;
+};
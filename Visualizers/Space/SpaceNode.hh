@@ -2,10 +2,12 @@
 
 #include <raindance/Core/Scene/Node.hh>
 
+#include "Core/ObjectPool.hh"
+
 #include "Visualizers/Space/SpaceResources.hh"
 #include "Visualizers/Space/SpaceWidgets.hh"
 
-class SpaceNode : public Scene::Node
+class SpaceNode : public Scene::Node, public Pooled<SpaceNode>
 {
 public:
     typedef unsigned long ID;
@@ -17,17 +19,19 @@ public:
         m_Color = glm::vec4(1.0, 1.0, 1.0, 1.0);
         m_Size = 1.0f;
         m_Mark = 0;
-        m_Label.set(label, g_SpaceResources->NodeFont);
+        m_Label = NULL;
+        m_LabelString = label != NULL ? std::string(label) : std::string();
         m_Activity = 0.0;
     }
 
     virtual ~SpaceNode()
     {
+        SAFE_DELETE(m_Label);
     }
 
     void draw(Context* context, const glm::mat4& projection, const glm::mat4& view, const glm::mat4& model)
     {
-        if (g_SpaceResources->ShowNodeShapes == SpaceResources::NONE && !g_SpaceResources->ShowNodeLabels)
+        if (g_SpaceResources->ShowNodeShapes == SpaceResources::NONE && !g_SpaceResources->ShowNodeActivity)
             return;
 
         glm::vec4 color = m_Color;
@@ -41,32 +45,18 @@ public:
         if (g_SpaceResources->ShowNodeShapes == SpaceResources::ALL || g_SpaceResources->ShowNodeShapes == SpaceResources::COLORS)
         {
             g_SpaceResources->NodeIcon->draw(context, projection * glm::scale(billboard, glm::vec3(nodeSize, nodeSize, nodeSize)), color, m_TextureID);
+            Stats::getInstance().drawCall(2);
         }
 
         if ((g_SpaceResources->ShowNodeShapes == SpaceResources::ALL || g_SpaceResources->ShowNodeShapes == SpaceResources::MARKS) && m_Mark > 0)
         {
-            glPolygonOffset(-1, -1);
-            glEnable(GL_POLYGON_OFFSET_FILL);
+            RenderState::getInstance().polygonOffset(-1, -1);
+            RenderState::getInstance().enable(GL_POLYGON_OFFSET_FILL);
             glm::vec4 markerColor = MarkerWidget::color(m_Mark);
             markerColor.a = color.a;
             g_SpaceResources->NodeMarkIcon->draw(context, projection * glm::scale(billboard, glm::vec3(nodeSize, nodeSize, nodeSize)), markerColor, 0);
-            glDisable(GL_POLYGON_OFFSET_FILL);
-        }
-
-        if (g_SpaceResources->ShowNodeLabels)
-        {
-            float labelRatio = 0.66;
-
-            float fontSize = m_Label.getFont()->getSize();
-            float textSize = labelRatio * nodeSize / (fontSize * m_Label.getFont()->getHeight());
-
-            Transformation transformation;
-            transformation.set(billboard);
-            transformation.translate(glm::vec3(nodeSize / 2 + 0.1, -nodeSize * (1 - labelRatio) / 2, 0.0));
-            transformation.scale(glm::vec3(textSize, textSize, 1.0));
-
-            m_Label.setColor(color);
-            m_Label.draw(context, projection * transformation.state());
+            Stats::getInstance().drawCall(2);
+            RenderState::getInstance().disable(GL_POLYGON_OFFSET_FILL);
         }
 
         if (g_SpaceResources->ShowNodeActivity && m_Activity > 0.0f)
@@ -78,9 +68,36 @@ public:
             glm::vec4 activityColor = glm::vec4(color.r, color.g, color.b, alpha);
 
             g_SpaceResources->NodeActivityIcon->draw(context, projection * glm::scale(billboard, glm::vec3(activitySize, activitySize, activitySize)), activityColor, 0);
+            Stats::getInstance().drawCall(2);
         }
     }
 
+    // NOTE : Called by the label pass once the label has been found readable and unoccluded.
+    void drawLabel(Context* context, const glm::mat4& projection, const glm::mat4& view, const glm::mat4& model)
+    {
+        if (m_Label == NULL)
+        {
+            m_Label = new Text();
+            m_Label->set(m_LabelString.c_str(), g_SpaceResources->NodeFont);
+        }
+
+        const float labelRatio = 0.66;
+
+        float nodeSize = getScreenSize();
+        glm::mat4 billboard = Geometry::billboard(view * model * getModelMatrix());
+
+        float fontSize = m_Label->getFont()->getSize();
+        float textSize = labelRatio * nodeSize / (fontSize * m_Label->getFont()->getHeight());
+
+        Transformation transformation;
+        transformation.set(billboard);
+        transformation.translate(glm::vec3(nodeSize / 2 + 0.1, -nodeSize * (1 - labelRatio) / 2, 0.0));
+        transformation.scale(glm::vec3(textSize, textSize, 1.0));
+
+        m_Label->setColor(m_Color);
+        m_Label->draw(context, projection * transformation.state());
+    }
+
     bool isOverlap (const glm::vec3& min, const glm::vec3& max) const
     {
         return Intersection::PointBox(getPosition(), min, max);
@@ -90,7 +107,13 @@ public:
     inline void setColor(const glm::vec4& color) { m_Color = color; }
     inline const glm::vec4& getColor() const { return m_Color; }
 
-    inline void setLabel(const char* label) { m_Label.set(label, g_SpaceResources->NodeFont); }
+    void setLabel(const char* label)
+    {
+        m_LabelString = label != NULL ? std::string(label) : std::string();
+        if (m_Label != NULL)
+            m_Label->set(m_LabelString.c_str(), g_SpaceResources->NodeFont);
+    }
+    inline const std::string& getLabel() const { return m_LabelString; }
 
     inline void setSize(float size) { m_Size = size; }
     inline float getSize() { return m_Size; }
@@ -120,6 +143,7 @@ private:
     glm::vec4 m_Color;
     float m_Size;
     unsigned int m_Mark;
-    Text m_Label;
+    Text* m_Label;
+    std::string m_LabelString;
     float m_Activity;
 };
@@ -0,0 +1,672 @@
+#pragma once
+
+#include <raindance/Core/Headers.hh>
+
+// NOTE : Loose octree of node bounding spheres. Each element lives in exactly one cell, whose bounds
+// are twice as large as the cell itself, so small moves don't require any reinsertion.
+// Cells are created on demand and the root grows when an element leaves it.
+class SpaceOctree
+{
+public:
+    typedef unsigned long ID;
+
+    struct Cluster
+    {
+        long Cell;
+        glm::vec3 Center; // NOTE : Centroid of the elements
+        glm::vec4 Color; // NOTE : Mean color of the elements
+        unsigned long Count;
+        float Size; // NOTE : Size of the cell
+    };
+
+    class Functor
+    {
+    public:
+        virtual ~Functor() {}
+        virtual void apply(ID id) = 0;
+        virtual void apply(const Cluster& cluster) { (void) cluster; }
+    };
+
+    class Filter
+    {
+    public:
+        virtual ~Filter() {}
+        virtual bool accept(ID id) = 0;
+    };
+
+    struct Cell
+    {
+        glm::vec3 Center;
+        float HalfSize;
+        unsigned int Depth;
+        long Parent;
+        long Children[8];
+        std::vector<ID> Elements;
+        unsigned long Count; // NOTE : Number of elements in the whole subtree
+        glm::vec3 PositionSum; // NOTE : Sum of the element positions in the whole subtree
+        glm::vec4 ColorSum; // NOTE : Sum of the element colors in the whole subtree
+    };
+
+    struct Element
+    {
+        long Cell;
+        unsigned long Index;
+        glm::vec3 Position;
+        float Radius;
+        glm::vec4 Color;
+        bool Changed; // NOTE : Listed in m_Changed
+    };
+
+    class Frustum
+    {
+    public:
+        // NOTE : Planes are extracted from the view projection matrix (Gribb & Hartmann)
+        Frustum(const glm::mat4& m)
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                m_Planes[2 * i]     = glm::vec4(m[0][3] + m[0][i], m[1][3] + m[1][i], m[2][3] + m[2][i], m[3][3] + m[3][i]);
+                m_Planes[2 * i + 1] = glm::vec4(m[0][3] - m[0][i], m[1][3] - m[1][i], m[2][3] - m[2][i], m[3][3] - m[3][i]);
+            }
+
+            for (int i = 0; i < 6; i++)
+                m_Planes[i] /= glm::length(glm::vec3(m_Planes[i]));
+        }
+
+        enum Result { OUTSIDE, INTERSECT, INSIDE };
+
+        Result testBox(const glm::vec3& center, float halfSize) const
+        {
+            Result result = INSIDE;
+
+            for (int i = 0; i < 6; i++)
+            {
+                glm::vec3 normal = glm::vec3(m_Planes[i]);
+                float distance = glm::dot(normal, center) + m_Planes[i].w;
+                float extent = halfSize * (fabs(normal.x) + fabs(normal.y) + fabs(normal.z));
+
+                if (distance < -extent)
+                    return OUTSIDE;
+                if (distance < extent)
+                    result = INTERSECT;
+            }
+
+            return result;
+        }
+
+        bool testSphere(const glm::vec3& center, float radius) const
+        {
+            for (int i = 0; i < 6; i++)
+                if (glm::dot(glm::vec3(m_Planes[i]), center) + m_Planes[i].w < -radius)
+                    return false;
+            return true;
+        }
+
+    private:
+        glm::vec4 m_Planes[6];
+    };
+
+    SpaceOctree()
+    {
+        MaxDepth = 12;
+        MaxElementsPerCell = 16;
+        clear();
+    }
+
+    virtual ~SpaceOctree()
+    {
+    }
+
+    void clear()
+    {
+        m_Cells.clear();
+        m_FreeCells.clear();
+        m_Elements.clear();
+        m_Changed.clear();
+        m_Root = createCell(glm::vec3(0, 0, 0), 1.0f, 0, -1);
+    }
+
+    void insert(ID id, const glm::vec3& position, float radius, const glm::vec4& color = glm::vec4(1.0, 1.0, 1.0, 1.0))
+    {
+        // NOTE : Diverging physics can produce NaNs, such elements can't be placed in the tree
+        if (position.x != position.x || position.y != position.y || position.z != position.z)
+            return;
+
+        if (id >= m_Elements.size())
+        {
+            Element empty;
+            empty.Cell = -1;
+            empty.Index = 0;
+            empty.Radius = 0.0f;
+            empty.Changed = false;
+            m_Elements.resize(id + 1, empty);
+        }
+
+        if (m_Elements[id].Cell >= 0)
+            unlink(id);
+
+        m_Elements[id].Position = position;
+        m_Elements[id].Radius = radius;
+        m_Elements[id].Color = color;
+
+        // NOTE : Re-center the tree on the first element instead of growing from the origin. An empty root
+        // can still hold a chain of empty children that a move is about to reuse, their bounds must stay valid.
+        if (m_Cells[m_Root].Count == 0 && isLeaf(m_Root))
+        {
+            m_Cells[m_Root].Center = position;
+            m_Cells[m_Root].HalfSize = std::max(1.0f, 2.0f * radius);
+        }
+
+        while (!fits(m_Root, position, radius))
+            grow(position);
+
+        link(id, descend(m_Root, position, radius));
+    }
+
+    void remove(ID id)
+    {
+        if (id >= m_Elements.size() || m_Elements[id].Cell < 0)
+            return;
+
+        unlink(id);
+    }
+
+    // NOTE : Elements only change cell when they leave the loose bounds of their current one.
+    void move(ID id, const glm::vec3& position, float radius, const glm::vec4& color = glm::vec4(1.0, 1.0, 1.0, 1.0))
+    {
+        if (id >= m_Elements.size() || m_Elements[id].Cell < 0)
+        {
+            insert(id, position, radius, color);
+            return;
+        }
+
+        Element& element = m_Elements[id];
+
+        if (fits(element.Cell, position, radius))
+        {
+            if (position != element.Position || color != element.Color)
+                accumulate(element.Cell, position - element.Position, color - element.Color);
+
+            element.Position = position;
+            element.Radius = radius;
+            element.Color = color;
+            return;
+        }
+
+        // NOTE : Climb up to the first ancestor that still contains the element
+        long previous = element.Cell;
+        long cell = previous;
+        while (cell != m_Root && !fits(cell, position, radius))
+            cell = m_Cells[cell].Parent;
+
+        unlink(id, false);
+
+        element.Position = position;
+        element.Radius = radius;
+        element.Color = color;
+
+        // NOTE : The old chain is only kept while it may be reused, insert may re-center an empty root
+        if (!fits(cell, position, radius))
+        {
+            prune(previous);
+            insert(id, position, radius, color);
+        }
+        else
+        {
+            link(id, descend(cell, position, radius));
+            prune(previous);
+        }
+    }
+
+    inline bool contains(ID id) const { return id < m_Elements.size() && m_Elements[id].Cell >= 0; }
+
+    void foreachElementsInsideFrustum(const Frustum& frustum, Functor* functor) const
+    {
+        visit(m_Root, frustum, false, functor);
+    }
+
+    // NOTE : Same as foreachElementsInsideFrustum, but cells whose projected size is below the threshold
+    // (in pixels) are reported as a single cluster instead of their elements.
+    void foreachClustersInsideFrustum(const Frustum& frustum, const glm::vec3& eye, float pixelScale, float threshold, Functor* functor) const
+    {
+        LODParameters lod;
+        lod.Eye = eye;
+        lod.PixelScale = pixelScale;
+        lod.Threshold = threshold;
+        visitClusters(m_Root, frustum, false, lod, functor);
+    }
+
+    void foreachElements(Functor* functor) const
+    {
+        for (ID id = 0; id < m_Elements.size(); id++)
+            if (m_Elements[id].Cell >= 0)
+                functor->apply(id);
+    }
+
+    // NOTE : Returns the closest element whose bounding sphere is hit by the ray. Cells farther than the best hit are skipped.
+    bool intersectRay(const glm::vec3& origin, const glm::vec3& direction, Filter* filter, ID* id, float* distance) const
+    {
+        glm::vec3 d = glm::normalize(direction);
+        glm::vec3 inverse = glm::vec3(1.0f / d.x, 1.0f / d.y, 1.0f / d.z);
+
+        float best = std::numeric_limits<float>::max();
+        long found = -1;
+
+        visitRay(m_Root, origin, d, inverse, filter, &best, &found);
+
+        if (found < 0)
+            return false;
+
+        if (id != NULL)
+            *id = static_cast<ID>(found);
+        if (distance != NULL)
+            *distance = best;
+        return true;
+    }
+
+    inline long getCell(ID id) const { return id < m_Elements.size() ? m_Elements[id].Cell : -1; }
+    inline long getParent(long cell) const { return m_Cells[cell].Parent; }
+
+    Cluster getCluster(long cell) const
+    {
+        const Cell& c = m_Cells[cell];
+
+        Cluster cluster;
+        cluster.Cell = cell;
+        cluster.Center = c.Count > 0 ? c.PositionSum / (float) c.Count : c.Center;
+        cluster.Color = c.Count > 0 ? c.ColorSum / (float) c.Count : glm::vec4(0, 0, 0, 0);
+        cluster.Count = c.Count;
+        cluster.Size = 2.0f * c.HalfSize;
+        return cluster;
+    }
+
+    // NOTE : Visits every element of the subtree rooted at the given cell
+    void foreachElementsInCell(long cell, Functor* functor) const
+    {
+        const Cell& c = m_Cells[cell];
+        if (c.Count == 0)
+            return;
+
+        for (auto id : c.Elements)
+            functor->apply(id);
+
+        for (int i = 0; i < 8; i++)
+            if (c.Children[i] >= 0)
+                foreachElementsInCell(c.Children[i], functor);
+    }
+
+    // NOTE : Elements that changed cell, were inserted or removed since the last clearChanged
+    inline const std::vector<ID>& changed() const { return m_Changed; }
+
+    void clearChanged()
+    {
+        for (auto id : m_Changed)
+            m_Elements[id].Changed = false;
+        m_Changed.clear();
+    }
+
+    inline unsigned long size() const { return m_Cells[m_Root].Count; }
+    inline unsigned long countCells() const { return m_Cells.size() - m_FreeCells.size(); }
+
+    unsigned int MaxDepth;
+    unsigned long MaxElementsPerCell;
+
+private:
+    long createCell(const glm::vec3& center, float halfSize, unsigned int depth, long parent)
+    {
+        long index;
+        if (!m_FreeCells.empty())
+        {
+            index = m_FreeCells.back();
+            m_FreeCells.pop_back();
+        }
+        else
+        {
+            index = m_Cells.size();
+            m_Cells.push_back(Cell());
+        }
+
+        Cell& cell = m_Cells[index];
+        cell.Center = center;
+        cell.HalfSize = halfSize;
+        cell.Depth = depth;
+        cell.Parent = parent;
+        for (int i = 0; i < 8; i++)
+            cell.Children[i] = -1;
+        cell.Elements.clear();
+        cell.Count = 0;
+        cell.PositionSum = glm::vec3(0, 0, 0);
+        cell.ColorSum = glm::vec4(0, 0, 0, 0);
+
+        return index;
+    }
+
+    inline bool fits(long cell, const glm::vec3& position, float radius) const
+    {
+        const Cell& c = m_Cells[cell];
+        float loose = 2.0f * c.HalfSize - radius;
+        glm::vec3 d = position - c.Center;
+        return fabs(d.x) <= loose && fabs(d.y) <= loose && fabs(d.z) <= loose;
+    }
+
+    inline int octant(const Cell& cell, const glm::vec3& position) const
+    {
+        return (position.x >= cell.Center.x ? 1 : 0) | (position.y >= cell.Center.y ? 2 : 0) | (position.z >= cell.Center.z ? 4 : 0);
+    }
+
+    inline glm::vec3 childCenter(long cell, int octant) const
+    {
+        float quarter = m_Cells[cell].HalfSize / 2;
+        return m_Cells[cell].Center + glm::vec3(octant & 1 ? quarter : -quarter, octant & 2 ? quarter : -quarter, octant & 4 ? quarter : -quarter);
+    }
+
+    // NOTE : Elements can sit outside the tight bounds of their cell, so they don't always fit in a child.
+    inline bool fitsChild(long cell, int octant, const glm::vec3& position, float radius) const
+    {
+        float loose = m_Cells[cell].HalfSize - radius;
+        glm::vec3 d = position - childCenter(cell, octant);
+        return fabs(d.x) <= loose && fabs(d.y) <= loose && fabs(d.z) <= loose;
+    }
+
+    long child(long cell, int octant)
+    {
+        if (m_Cells[cell].Children[octant] < 0)
+        {
+            long index = createCell(childCenter(cell, octant), m_Cells[cell].HalfSize / 2, m_Cells[cell].Depth + 1, cell);
+            m_Cells[cell].Children[octant] = index;
+        }
+        return m_Cells[cell].Children[octant];
+    }
+
+    inline bool isLeaf(long cell) const
+    {
+        for (int i = 0; i < 8; i++)
+            if (m_Cells[cell].Children[i] >= 0)
+                return false;
+        return true;
+    }
+
+    // NOTE : Finds the deepest existing cell for an element, splitting full leaves on the way.
+    long descend(long cell, const glm::vec3& position, float radius)
+    {
+        while (true)
+        {
+            Cell& c = m_Cells[cell];
+
+            if (c.Depth >= MaxDepth)
+                return cell;
+
+            int o = octant(c, position);
+            if (!fitsChild(cell, o, position, radius))
+                return cell;
+
+            if (isLeaf(cell))
+            {
+                if (c.Elements.size() < MaxElementsPerCell)
+                    return cell;
+                split(cell);
+            }
+
+            cell = child(cell, o);
+        }
+    }
+
+    void split(long cell)
+    {
+        std::vector<ID> elements;
+        elements.swap(m_Cells[cell].Elements);
+
+        for (auto id : elements)
+        {
+            Element& element = m_Elements[id];
+
+            long target = cell;
+            int o = octant(m_Cells[cell], element.Position);
+            if (fitsChild(cell, o, element.Position, element.Radius))
+                target = child(cell, o);
+
+            Cell& c = m_Cells[target];
+            if (target != element.Cell)
+                change(id);
+            element.Cell = target;
+            element.Index = c.Elements.size();
+            c.Elements.push_back(id);
+            if (target != cell)
+            {
+                c.Count++;
+                c.PositionSum += element.Position;
+                c.ColorSum += element.Color;
+            }
+        }
+    }
+
+    void grow(const glm::vec3& position)
+    {
+        Cell& root = m_Cells[m_Root];
+
+        // NOTE : The old root becomes the child of the new root on the side opposite to the position
+        glm::vec3 direction = position - root.Center;
+        glm::vec3 offset = glm::vec3(direction.x >= 0 ? root.HalfSize : -root.HalfSize,
+                                     direction.y >= 0 ? root.HalfSize : -root.HalfSize,
+                                     direction.z >= 0 ? root.HalfSize : -root.HalfSize);
+
+        long previous = m_Root;
+        m_Root = createCell(root.Center + offset, 2.0f * root.HalfSize, 0, -1);
+
+        Cell& newRoot = m_Cells[m_Root];
+        newRoot.Children[octant(newRoot, m_Cells[previous].Center)] = previous;
+        newRoot.Count = m_Cells[previous].Count;
+        newRoot.PositionSum = m_Cells[previous].PositionSum;
+        newRoot.ColorSum = m_Cells[previous].ColorSum;
+        m_Cells[previous].Parent = m_Root;
+
+        deepen(previous);
+    }
+
+    void deepen(long cell)
+    {
+        m_Cells[cell].Depth++;
+        for (int i = 0; i < 8; i++)
+            if (m_Cells[cell].Children[i] >= 0)
+                deepen(m_Cells[cell].Children[i]);
+    }
+
+    void link(ID id, long cell)
+    {
+        Element& element = m_Elements[id];
+        element.Cell = cell;
+        element.Index = m_Cells[cell].Elements.size();
+        m_Cells[cell].Elements.push_back(id);
+        change(id);
+
+        for (long c = cell; c >= 0; c = m_Cells[c].Parent)
+        {
+            m_Cells[c].Count++;
+            m_Cells[c].PositionSum += element.Position;
+            m_Cells[c].ColorSum += element.Color;
+        }
+    }
+
+    inline void change(ID id)
+    {
+        if (m_Elements[id].Changed)
+            return;
+
+        m_Elements[id].Changed = true;
+        m_Changed.push_back(id);
+    }
+
+    void accumulate(long cell, const glm::vec3& position, const glm::vec4& color)
+    {
+        for (long c = cell; c >= 0; c = m_Cells[c].Parent)
+        {
+            m_Cells[c].PositionSum += position;
+            m_Cells[c].ColorSum += color;
+        }
+    }
+
+    void unlink(ID id, bool release = true)
+    {
+        Element& element = m_Elements[id];
+        Cell& cell = m_Cells[element.Cell];
+
+        ID last = cell.Elements.back();
+        cell.Elements[element.Index] = last;
+        m_Elements[last].Index = element.Index;
+        cell.Elements.pop_back();
+
+        long c = element.Cell;
+        element.Cell = -1;
+        change(id);
+
+        for (long p = c; p >= 0; p = m_Cells[p].Parent)
+        {
+            m_Cells[p].Count--;
+            m_Cells[p].PositionSum -= element.Position;
+            m_Cells[p].ColorSum -= element.Color;
+        }
+
+        if (release)
+            prune(c);
+    }
+
+    // NOTE : Releases empty leaves so that the tree follows the elements as they move
+    void prune(long cell)
+    {
+        while (cell != m_Root && m_Cells[cell].Count == 0 && isLeaf(cell))
+        {
+            long parent = m_Cells[cell].Parent;
+            for (int i = 0; i < 8; i++)
+                if (m_Cells[parent].Children[i] == cell)
+                    m_Cells[parent].Children[i] = -1;
+            m_FreeCells.push_back(cell);
+            cell = parent;
+        }
+    }
+
+    void visit(long cell, const Frustum& frustum, bool inside, Functor* functor) const
+    {
+        const Cell& c = m_Cells[cell];
+        if (c.Count == 0)
+            return;
+
+        if (!inside)
+        {
+            Frustum::Result result = frustum.testBox(c.Center, 2.0f * c.HalfSize);
+            if (result == Frustum::OUTSIDE)
+                return;
+            inside = result == Frustum::INSIDE;
+        }
+
+        for (auto id : c.Elements)
+            if (inside || frustum.testSphere(m_Elements[id].Position, m_Elements[id].Radius))
+                functor->apply(id);
+
+        for (int i = 0; i < 8; i++)
+            if (c.Children[i] >= 0)
+                visit(c.Children[i], frustum, inside, functor);
+    }
+
+    struct LODParameters
+    {
+        glm::vec3 Eye;
+        float PixelScale;
+        float Threshold;
+    };
+
+    void visitClusters(long cell, const Frustum& frustum, bool inside, const LODParameters& lod, Functor* functor) const
+    {
+        const Cell& c = m_Cells[cell];
+        if (c.Count == 0)
+            return;
+
+        if (!inside)
+        {
+            Frustum::Result result = frustum.testBox(c.Center, 2.0f * c.HalfSize);
+            if (result == Frustum::OUTSIDE)
+                return;
+            inside = result == Frustum::INSIDE;
+        }
+
+        if (c.Count > 1)
+        {
+            float size = 4.0f * c.HalfSize;
+            float distance = glm::length(c.Center - lod.Eye);
+
+            // NOTE : Never collapse a cell the eye is inside of
+            if (distance > size && size * lod.PixelScale / distance < lod.Threshold)
+            {
+                Cluster cluster;
+                cluster.Cell = cell;
+                cluster.Center = c.PositionSum / (float) c.Count;
+                cluster.Color = c.ColorSum / (float) c.Count;
+                cluster.Count = c.Count;
+                cluster.Size = 2.0f * c.HalfSize;
+                functor->apply(cluster);
+                return;
+            }
+        }
+
+        for (auto id : c.Elements)
+            if (inside || frustum.testSphere(m_Elements[id].Position, m_Elements[id].Radius))
+                functor->apply(id);
+
+        for (int i = 0; i < 8; i++)
+            if (c.Children[i] >= 0)
+                visitClusters(c.Children[i], frustum, inside, lod, functor);
+    }
+
+    void visitRay(long cell, const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& inverse, Filter* filter, float* best, long* found) const
+    {
+        const Cell& c = m_Cells[cell];
+        if (c.Count == 0)
+            return;
+
+        // NOTE : Slab test against the loose bounds of the cell
+        glm::vec3 t0 = (c.Center - glm::vec3(2.0f * c.HalfSize) - origin) * inverse;
+        glm::vec3 t1 = (c.Center + glm::vec3(2.0f * c.HalfSize) - origin) * inverse;
+        glm::vec3 tmin = glm::min(t0, t1);
+        glm::vec3 tmax = glm::max(t0, t1);
+
+        float enter = std::max(std::max(tmin.x, tmin.y), tmin.z);
+        float exit = std::min(std::min(tmax.x, tmax.y), tmax.z);
+
+        if (exit < std::max(enter, 0.0f) || enter > *best)
+            return;
+
+        for (auto id : c.Elements)
+        {
+            const Element& element = m_Elements[id];
+
+            glm::vec3 oc = origin - element.Position;
+            float b = glm::dot(oc, direction);
+            float discriminant = b * b - (glm::dot(oc, oc) - element.Radius * element.Radius);
+            if (discriminant < 0.0f)
+                continue;
+
+            float root = sqrt(discriminant);
+            float t = -b - root;
+            if (t < 0.0f)
+                t = -b + root;
+
+            if (t < 0.0f || t >= *best)
+                continue;
+
+            if (filter != NULL && !filter->accept(id))
+                continue;
+
+            *best = t;
+            *found = static_cast<long>(id);
+        }
+
+        for (int i = 0; i < 8; i++)
+            if (c.Children[i] >= 0)
+                visitRay(c.Children[i], origin, direction, inverse, filter, best, found);
+    }
+
+    std::vector<Cell> m_Cells;
+    std::vector<long> m_FreeCells;
+    std::vector<Element> m_Elements;
+    std::vector<ID> m_Changed;
+    long m_Root;
+};
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "Core/DynamicBuffer.hh"
+#include "Core/RenderTarget.hh"
+
+#include "Visualizers/Space/SpaceResources.hh"
+
+// NOTE : GPU node picking. Node IDs are rendered as colored discs in an offscreen buffer, and picking
+// reads back a single pixel. The ID buffer is only rendered again when the camera or a node changed.
+class SpacePicker
+{
+public:
+    typedef unsigned long ID;
+
+    struct Vertex
+    {
+        glm::vec3 Position;
+        float Radius;
+        unsigned char Color[4];
+        float LOD;
+    };
+
+    SpacePicker()
+    : m_Buffer(sizeof(Vertex), 1)
+    {
+        m_Buffer.describe("a_Position", 3, GL_FLOAT,         GL_FALSE, offsetof(Vertex, Position));
+        m_Buffer.describe("a_Radius",   1, GL_FLOAT,         GL_FALSE, offsetof(Vertex, Radius));
+        m_Buffer.describe("a_Color",    4, GL_UNSIGNED_BYTE, GL_TRUE,  offsetof(Vertex, Color));
+        m_Buffer.describe("a_LOD",      1, GL_FLOAT,         GL_FALSE, offsetof(Vertex, LOD));
+
+        m_Dirty = true;
+        m_Width = 0;
+        m_Height = 0;
+    }
+
+    virtual ~SpacePicker()
+    {
+    }
+
+    void update(ID id, const glm::vec3& position, float radius, float lod)
+    {
+        if (id >= m_Slots.size())
+            m_Slots.resize(id + 1, DynamicBuffer::InvalidSlot);
+
+        if (m_Slots[id] == DynamicBuffer::InvalidSlot)
+            m_Slots[id] = m_Buffer.allocate();
+
+        // NOTE : IDs are shifted by one so that black means no node
+        unsigned long code = id + 1;
+
+        Vertex* vertex = m_Buffer.vertices<Vertex>(m_Slots[id]);
+        vertex->Position = position;
+        vertex->Radius = radius;
+        vertex->Color[0] = (unsigned char) (code & 0xFF);
+        vertex->Color[1] = (unsigned char) ((code >> 8) & 0xFF);
+        vertex->Color[2] = (unsigned char) ((code >> 16) & 0xFF);
+        vertex->Color[3] = 255;
+        vertex->LOD = lod;
+
+        m_Buffer.touch(m_Slots[id]);
+        m_Dirty = true;
+    }
+
+    void remove(ID id)
+    {
+        if (id >= m_Slots.size() || m_Slots[id] == DynamicBuffer::InvalidSlot)
+            return;
+
+        Vertex* vertex = m_Buffer.vertices<Vertex>(m_Slots[id]);
+        vertex->Radius = 0.0f;
+
+        m_Buffer.release(m_Slots[id]);
+        m_Slots[id] = DynamicBuffer::InvalidSlot;
+        m_Dirty = true;
+    }
+
+    void clear()
+    {
+        for (ID id = 0; id < m_Slots.size(); id++)
+            remove(id);
+    }
+
+    bool pick(int x, int y, Camera& camera, const glm::vec2& viewport, const glm::mat4& model, ID* id)
+    {
+        int width = static_cast<int>(viewport.x);
+        int height = static_cast<int>(viewport.y);
+
+        if (x < 0 || y < 0 || x >= width || y >= height)
+            return false;
+
+        if (!m_Target.resize(width, height))
+            return false;
+
+        glm::mat4 modelViewProjection = camera.getViewProjectionMatrix() * model;
+        glm::vec3 lod = glm::vec3(g_SpaceResources->ShowNodeLOD ? 1.0 : 0.0, g_SpaceResources->LODSlice[0], g_SpaceResources->LODSlice[1]);
+
+        m_Target.bind();
+
+        if (m_Dirty || modelViewProjection != m_ModelViewProjection || lod != m_LOD || width != m_Width || height != m_Height)
+        {
+            m_ModelViewProjection = modelViewProjection;
+            m_LOD = lod;
+            m_Width = width;
+            m_Height = height;
+            render(camera, height);
+            m_Dirty = false;
+        }
+
+        unsigned char pixel[4];
+        m_Target.read(x, height - 1 - y, 1, 1, pixel);
+
+        m_Target.unbind();
+
+        unsigned long code = pixel[0] | (pixel[1] << 8) | (pixel[2] << 16);
+        if (code == 0)
+            return false;
+
+        if (id != NULL)
+            *id = code - 1;
+        return true;
+    }
+
+private:
+    void render(Camera& camera, int height)
+    {
+        glClearColor(0, 0, 0, 0);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        if (m_Buffer.count() == 0)
+            return;
+
+        m_Buffer.upload();
+
+        RenderState::getInstance().disable(GL_BLEND);
+        RenderState::getInstance().enable(GL_DEPTH_TEST);
+        #ifndef EMSCRIPTEN
+            // NOTE : Always enabled in WebGL
+            RenderState::getInstance().enable(GL_VERTEX_PROGRAM_POINT_SIZE);
+            #ifdef GL_POINT_SPRITE
+                RenderState::getInstance().enable(GL_POINT_SPRITE);
+            #endif
+        #endif
+
+        Shader::Program* shader = g_SpaceResources->PickingShader;
+        RenderState::getInstance().use(shader);
+        shader->uniform("u_ModelViewProjection").set(m_ModelViewProjection);
+        shader->uniform("u_PixelScale").set(0.5f * height * camera.getProjectionMatrix()[1][1]);
+        shader->uniform("u_LOD").set(m_LOD);
+
+        m_Buffer.bind();
+        glDrawArrays(GL_POINTS, 0, m_Buffer.count());
+        Stats::getInstance().drawCall(m_Buffer.count());
+        m_Buffer.unbind();
+
+        RenderState::getInstance().disable(GL_DEPTH_TEST);
+        RenderState::getInstance().enable(GL_BLEND);
+    }
+
+    DynamicBuffer m_Buffer;
+    std::vector<DynamicBuffer::Slot> m_Slots;
+    RenderTarget m_Target;
+
+    bool m_Dirty;
+    glm::mat4 m_ModelViewProjection;
+    glm::vec3 m_LOD;
+    int m_Width;
+    int m_Height;
+};
@@ -1,5 +1,10 @@
 #pragma once
 
+#include "Core/Uniforms.hh"
+#include "Core/RenderState.hh"
+#include "Core/Stats.hh"
+#include "Core/Profiler.hh"
+
 class SpaceResources
 {
 public:
@@ -26,6 +31,8 @@ public:
 			ShowDebug = false;
 
 			LODSlice = glm::vec2(0.0, 1.0);
+			AutoLOD = false;
+			AutoLODThreshold = 16.0f;
 			ShowNodeLOD = false;
 			ShowEdgeLOD = false;
 
@@ -297,6 +304,17 @@ public:
 			NodeFont = new Font();
 			NodeActivityIcon = new Icon();
 			NodeActivityIcon->load("node_activity", Assets_SpaceView_node_activity_png, sizeof(Assets_SpaceView_node_activity_png));
+
+			PickingShader = ResourceManager::getInstance().loadShader("graph:picking",
+			        Assets_SpaceView_picking_vert, sizeof(Assets_SpaceView_picking_vert),
+			        Assets_SpaceView_picking_frag, sizeof(Assets_SpaceView_picking_frag));
+
+			DensityShader = ResourceManager::getInstance().loadShader("graph:density",
+			        Assets_SpaceView_density_vert, sizeof(Assets_SpaceView_density_vert),
+			        Assets_SpaceView_density_frag, sizeof(Assets_SpaceView_density_frag));
+			ColormapShader = ResourceManager::getInstance().loadShader("graph:colormap",
+			        Assets_SpaceView_colormap_vert, sizeof(Assets_SpaceView_colormap_vert),
+			        Assets_SpaceView_colormap_frag, sizeof(Assets_SpaceView_colormap_frag));
 		}
 
 		// Edges
@@ -305,8 +323,8 @@ public:
             EdgeActivityIcon->load("link_activity", Assets_Particle_metaball_png, sizeof(Assets_Particle_metaball_png));
 
 		    EdgeShader = ResourceManager::getInstance().loadShader("graph:edges",
-		            Assets_Shaders_Primitives_wideline_vert, sizeof(Assets_Shaders_Primitives_wideline_vert),
-		            Assets_Shaders_Primitives_wideline_frag, sizeof(Assets_Shaders_Primitives_wideline_frag));
+		            Assets_SpaceView_edges_vert, sizeof(Assets_SpaceView_edges_vert),
+		            Assets_SpaceView_edges_frag, sizeof(Assets_SpaceView_edges_frag));
 
 		    EdgeStyleIcon = new Icon();
             EdgeStyleIcon->load("styles/solid", Assets_SpaceView_EdgeStyles_solid_png, sizeof(Assets_SpaceView_EdgeStyles_solid_png));
@@ -340,6 +358,9 @@ public:
 		SAFE_DELETE(NodeTargetIcon);
 		SAFE_DELETE(NodeFont);
 		SAFE_DELETE(NodeActivityIcon);
+		ResourceManager::getInstance().unload(PickingShader);
+		ResourceManager::getInstance().unload(DensityShader);
+		ResourceManager::getInstance().unload(ColormapShader);
 
         ResourceManager::getInstance().unload(EdgeShader);
         SAFE_DELETE(EdgeStyleIcon);
@@ -384,18 +405,26 @@ public:
     bool ShowNodeLOD;
     bool ShowEdgeLOD;
 	glm::vec2 LODSlice;
+	bool AutoLOD;
+	float AutoLODThreshold; // NOTE : Projected cell size (in pixels) under which nodes are drawn as one impostor
 
 	GraphModel* Model;
 
+	FrameUniforms Frame; // NOTE : Camera of the frame being drawn
+
 	// Nodes
 	Icon* NodeIcon;
 	Icon* NodeMarkIcon;
 	Icon* NodeTargetIcon;
 	Font* NodeFont;
 	Icon* NodeActivityIcon;
+	Shader::Program* PickingShader;
+	Shader::Program* DensityShader;
+	Shader::Program* ColormapShader;
 
 	// Edges
     Shader::Program* EdgeShader;
+    UniformCache EdgeUniforms;
     Icon* EdgeStyleIcon;
 	LinkMode m_LinkMode;
 	Icon* EdgeActivityIcon;
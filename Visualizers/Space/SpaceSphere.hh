@@ -3,6 +3,8 @@
 #include "Visualizers/Space/SpaceResources.hh"
 #include "Visualizers/Space/SpaceWidgets.hh"
 
+#include "Core/NodeCompaction.hh"
+
 class SpaceSphere : public Scene::Node
 {
 public:
@@ -50,3 +52,208 @@ private:
     glm::vec4 m_Color;
     float m_LOD;
 };
+
+// NOTE : Sphere membership in local node IDs, with bounds maintained incrementally. Tagging a node grows the
+// bound in constant time, only the spheres whose members moved or left are refit with Ritter's algorithm:
+// an initial sphere spanning two far apart members, then a growing pass. Bounds always enclose every member
+// but aren't minimal, a refit one is typically 5 to 20% larger, a grown one may be looser until it is refit.
+class SpaceSphereBounds
+{
+public:
+    virtual ~SpaceSphereBounds() {}
+
+    void addSphere(SpaceSphere::ID sphere)
+    {
+        if (sphere >= m_Spheres.size())
+            m_Spheres.resize(sphere + 1);
+        m_Spheres[sphere] = Bound();
+    }
+
+    void tag(unsigned long node, SpaceSphere::ID sphere, const glm::vec3& position)
+    {
+        if (sphere >= m_Spheres.size())
+            m_Spheres.resize(sphere + 1);
+        if (node >= m_NodeSpheres.size())
+            m_NodeSpheres.resize(node + 1);
+        m_NodeSpheres[node].push_back(sphere);
+
+        Bound& bound = m_Spheres[sphere];
+        bound.Members.push_back(node);
+        grow(bound, position, bound.Members.size() == 1);
+        mark(sphere);
+    }
+
+    // NOTE : Must be called whenever a node moves
+    inline void move(unsigned long node)
+    {
+        if (node >= m_NodeSpheres.size())
+            return;
+
+        for (auto sphere : m_NodeSpheres[node])
+        {
+            m_Spheres[sphere].Refit = true;
+            mark(sphere);
+        }
+    }
+
+    void remove(unsigned long node)
+    {
+        if (node >= m_NodeSpheres.size())
+            return;
+
+        for (auto sphere : m_NodeSpheres[node])
+        {
+            std::vector<unsigned long>& members = m_Spheres[sphere].Members;
+            for (unsigned long i = 0; i < members.size(); i++)
+            {
+                if (members[i] == node)
+                {
+                    members[i] = members.back();
+                    members.pop_back();
+                    break;
+                }
+            }
+
+            m_Spheres[sphere].Refit = true;
+            mark(sphere);
+        }
+
+        m_NodeSpheres[node].clear();
+    }
+
+    // NOTE : Follows a compaction of the node vector
+    void remap(const std::vector<unsigned long>& remap)
+    {
+        std::vector< std::vector<SpaceSphere::ID> > nodeSpheres;
+        for (unsigned long i = 0; i < m_NodeSpheres.size() && i < remap.size(); i++)
+        {
+            if (remap[i] == NodeCompaction::Invalid || m_NodeSpheres[i].empty())
+                continue;
+
+            if (remap[i] >= nodeSpheres.size())
+                nodeSpheres.resize(remap[i] + 1);
+            nodeSpheres[remap[i]].swap(m_NodeSpheres[i]);
+        }
+        m_NodeSpheres.swap(nodeSpheres);
+
+        for (auto& bound : m_Spheres)
+            for (auto& member : bound.Members)
+                member = remap[member];
+    }
+
+    // NOTE : Refits the marked spheres and pushes the changed bounds to their scene nodes. Returns whether anything changed.
+    bool update(Scene::NodeVector& nodes, Scene::NodeVector& spheres)
+    {
+        if (m_Dirty.empty())
+            return false;
+
+        for (auto id : m_Dirty)
+        {
+            Bound& bound = m_Spheres[id];
+
+            if (bound.Refit)
+                refit(bound, nodes);
+
+            if (bound.Members.empty())
+            {
+                bound.Center = glm::vec3(0, 0, 0);
+                bound.Radius = 0;
+            }
+
+            if (id < spheres.size() && spheres[id] != NULL)
+            {
+                spheres[id]->setPosition(bound.Center);
+                static_cast<SpaceSphere*>(spheres[id])->setRadius(std::max(bound.Radius, 1.0f));
+            }
+
+            bound.Refit = false;
+            bound.Marked = false;
+        }
+
+        m_Dirty.clear();
+        return true;
+    }
+
+private:
+    struct Bound
+    {
+        Bound() : Center(0, 0, 0), Radius(0), Refit(false), Marked(false) {}
+
+        glm::vec3 Center;
+        float Radius;
+        std::vector<unsigned long> Members;
+        bool Refit;
+        bool Marked;
+    };
+
+    // NOTE : Ritter's growing step, the sphere is moved toward the outside point just enough to enclose it.
+    static inline void grow(Bound& bound, const glm::vec3& position, bool first)
+    {
+        if (first)
+        {
+            bound.Center = position;
+            bound.Radius = 0;
+            return;
+        }
+
+        glm::vec3 delta = position - bound.Center;
+        float distance2 = glm::dot(delta, delta);
+        if (distance2 <= bound.Radius * bound.Radius)
+            return;
+
+        float distance = sqrtf(distance2);
+        float radius = 0.5f * (bound.Radius + distance);
+        bound.Center += delta * ((radius - bound.Radius) / distance);
+        bound.Radius = radius;
+    }
+
+    // NOTE : Ritter's algorithm. The initial sphere spans the member farthest from the first one and the member
+    // farthest from that one, the growing pass then takes in the members left outside.
+    static void refit(Bound& bound, Scene::NodeVector& nodes)
+    {
+        if (bound.Members.empty())
+            return;
+
+        glm::vec3 a = farthest(bound, nodes, nodes[bound.Members[0]]->getPosition());
+        glm::vec3 b = farthest(bound, nodes, a);
+
+        bound.Center = 0.5f * (a + b);
+        bound.Radius = 0.5f * glm::length(b - a);
+
+        for (auto member : bound.Members)
+            grow(bound, nodes[member]->getPosition(), false);
+    }
+
+    static glm::vec3 farthest(const Bound& bound, Scene::NodeVector& nodes, const glm::vec3& from)
+    {
+        glm::vec3 result = from;
+        float max = 0;
+
+        for (auto member : bound.Members)
+        {
+            glm::vec3 position = nodes[member]->getPosition();
+            glm::vec3 delta = position - from;
+            float distance2 = glm::dot(delta, delta);
+            if (distance2 > max)
+            {
+                max = distance2;
+                result = position;
+            }
+        }
+
+        return result;
+    }
+
+    inline void mark(SpaceSphere::ID sphere)
+    {
+        if (m_Spheres[sphere].Marked)
+            return;
+
+        m_Spheres[sphere].Marked = true;
+        m_Dirty.push_back(sphere);
+    }
+
+    std::vector<Bound> m_Spheres;
+    std::vector< std::vector<SpaceSphere::ID> > m_NodeSpheres;
+    std::vector<SpaceSphere::ID> m_Dirty;
+};
@@ -14,7 +14,6 @@
 #include <raindance/Core/Physics.hh>
 #include <raindance/Core/Environment.hh>
 #include <raindance/Core/Bezier.hh>
-#include <raindance/Core/Octree.hh>
 #include <raindance/Core/GUI/Wallpaper.hh>
 
 #include "Entities/MVC.hh"
@@ -25,45 +24,111 @@
 #include "Visualizers/Space/SpaceNode.hh"
 #include "Visualizers/Space/SpaceEdge.hh"
 #include "Visualizers/Space/SpaceSphere.hh"
+#include "Visualizers/Space/SpaceLabels.hh"
+#include "Visualizers/Space/SpaceOctree.hh"
+#include "Visualizers/Space/SpacePicker.hh"
+#include "Visualizers/Space/SpaceDensity.hh"
+#include "Visualizers/Space/SpaceMetaEdges.hh"
 
 #include "Visualizers/Space/SpaceResources.hh"
 
-typedef TranslationMap<SpaceNode::ID, Node::ID> NodeTranslationMap;
-typedef TranslationMap<SpaceEdge::ID, Link::ID> LinkTranslationMap;
+typedef DenseTranslationMap<SpaceNode::ID, Node::ID> NodeTranslationMap;
+typedef DenseTranslationMap<SpaceEdge::ID, Link::ID> LinkTranslationMap;
 #include "Visualizers/Space/SpaceForces.hh"
 
 #include "Pack.hh"
  
-class SpaceRenderer : public OctreeFunctor
+class SpaceRenderer : public SpaceOctree::Functor
 {
 public:
-    SpaceRenderer(GraphContext* context, Camera* camera, Transformation* transformation, int pass)
-    : m_Context(context), m_Camera(camera), m_Transformation(transformation), m_Pass(pass)
+    // NOTE : The IDs of the nodes drawn on their own are appended to visible, when given
+    SpaceRenderer(GraphContext* context, Camera* camera, Transformation* transformation, Scene::NodeVector* nodes, std::vector<SpaceOctree::ID>* visible = NULL)
+    : m_Context(context), m_Camera(camera), m_Transformation(transformation), m_Nodes(nodes), m_Visible(visible)
     {
         m_DrawCount = 0;
+        m_ClusterCount = 0;
+        m_NodeCount = 0;
     }
 
     virtual ~SpaceRenderer() {}
 
-    virtual void apply(OctreeElement* element)
+    virtual void apply(SpaceOctree::ID id)
     {
-        Scene::Node* node = static_cast<Scene::Node*>(element);
-        if (node->getMark() != m_Pass)
-        {
-            node->draw(m_Context, m_Camera->getProjectionMatrix(), m_Camera->getViewMatrix(), m_Transformation->state());
-            node->setMark(m_Pass);
-            m_DrawCount++;
-        }
+        (*m_Nodes)[id]->draw(m_Context, m_Camera->getProjectionMatrix(), m_Camera->getViewMatrix(), m_Transformation->state());
+        m_DrawCount++;
+        m_NodeCount++;
+
+        if (m_Visible != NULL)
+            m_Visible->push_back(id);
+    }
+
+    // NOTE : Cluster impostors grow with the number of nodes they stand for, but never exceed their cell.
+    virtual void apply(const SpaceOctree::Cluster& cluster)
+    {
+        float size = std::min(cluster.Size, g_SpaceResources->NodeIconSize * sqrtf((float) cluster.Count));
+
+        glm::mat4 billboard = Geometry::billboard(m_Camera->getViewMatrix() * glm::translate(m_Transformation->state(), cluster.Center));
+        g_SpaceResources->NodeIcon->draw(m_Context, m_Camera->getProjectionMatrix() * glm::scale(billboard, glm::vec3(size, size, size)), cluster.Color, 0);
+        Stats::getInstance().drawCall(2);
+
+        m_DrawCount++;
+        m_ClusterCount++;
+        m_NodeCount += cluster.Count;
     }
 
  inline int getDrawCount() { return m_DrawCount; }
+ inline int getClusterCount() { return m_ClusterCount; }
+ inline unsigned long getNodeCount() { return m_NodeCount; }
 
 private:
     GraphContext* m_Context;
     Camera* m_Camera;
     Transformation* m_Transformation;
-    int m_Pass;
+    Scene::NodeVector* m_Nodes;
+    std::vector<SpaceOctree::ID>* m_Visible;
     int m_DrawCount;
+    int m_ClusterCount;
+    unsigned long m_NodeCount; // NOTE : Nodes drawn on their own or as part of a cluster
+};
+
+// NOTE : Records the result of a clustered traversal so that the edges can be aggregated before the nodes are drawn.
+class SpaceClusterCollector : public SpaceOctree::Functor
+{
+public:
+    virtual ~SpaceClusterCollector() {}
+
+    virtual void apply(SpaceOctree::ID id) { Elements.push_back(id); }
+    virtual void apply(const SpaceOctree::Cluster& cluster) { Clusters.push_back(cluster); }
+
+    void replay(SpaceOctree::Functor* functor)
+    {
+        for (auto id : Elements)
+            functor->apply(id);
+        for (auto& cluster : Clusters)
+            functor->apply(cluster);
+    }
+
+    std::vector<SpaceOctree::ID> Elements;
+    std::vector<SpaceOctree::Cluster> Clusters;
+};
+
+class SpacePickingFilter : public SpaceOctree::Filter
+{
+public:
+    SpacePickingFilter(Scene::NodeVector* nodes)
+    : m_Nodes(nodes)
+    {
+    }
+
+    virtual ~SpacePickingFilter() {}
+
+    virtual bool accept(SpaceOctree::ID id)
+    {
+        return g_SpaceResources->isNodeVisible((*m_Nodes)[id]->getLOD());
+    }
+
+private:
+    Scene::NodeVector* m_Nodes;
 };
 
 class SpaceView : public GraphView
@@ -71,6 +136,8 @@ class SpaceView : public GraphView
  public:
 
      enum PhysicsMode { PLAY, PAUSE };
+     enum PickingMode { OCTREE_PICKING, GPU_PICKING };
+     enum RenderMode { NODE_RENDERING, DENSITY_RENDERING };
 
      SpaceView()
      {
@@ -80,19 +147,17 @@ class SpaceView : public GraphView
   
          m_GraphEntity = NULL;
  
-         m_Octree = NULL;
-         m_DirtyOctree = false;
- 
          m_PhysicsMode = PAUSE;
+         m_PickingMode = OCTREE_PICKING;
+         m_RenderMode = NODE_RENDERING;
          m_LastUpdateTime = 0;
          m_Iterations = 0;
          m_Temperature = 0.2f;
+         m_ActiveNodeCount = 0;
      }
  
     virtual ~SpaceView()
     {
-        SAFE_DELETE(m_Octree);
-
         delete g_SpaceResources;
     }
 
@@ -154,6 +219,7 @@ class SpaceView : public GraphView
 
             SpaceNode* node = static_cast<SpaceNode*>(m_SpaceNodes[n]);
             node->setColor(tint * node->getColor());
+            updateNode(n);
         }
     }
  
@@ -253,63 +319,103 @@ class SpaceView : public GraphView
  
     void draw()
     {
+        PROFILE_ZONE("SpaceView::draw");
+
+        m_Invalidated.exchange(false);
+
         const glm::vec4 bgcolor = glm::vec4(BLACK, 1.0);
         glClearColor(bgcolor.r, bgcolor.g, bgcolor.b, bgcolor.a);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         #ifndef EMSCRIPTEN // NOTE : WebGL doesn't like rectangle images
             g_SpaceResources->m_Wallpaper->draw(context());
+            RenderState::getInstance().invalidate();
         #endif
  
-        glDisable(GL_DEPTH_TEST);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_DST_ALPHA);
+        RenderState::getInstance().disable(GL_DEPTH_TEST);
+        RenderState::getInstance().enable(GL_BLEND);
+        RenderState::getInstance().blendFunc(GL_SRC_ALPHA, GL_DST_ALPHA);
  
          // NOTE : In the future, we want to disable the depth test, and render the image by layers.
          // However this means we need to sort the nodes by distance to the eye and use the Painter's algorithm
  
         Transformation transformation;
 
+        g_SpaceResources->Frame.update(m_Camera.getViewMatrix(), m_Camera.getProjectionMatrix());
+
+        SpaceOctree::Frustum frustum(m_Camera.getViewProjectionMatrix() * transformation.state());
+
+        // NOTE : The clustered traversal runs before the edges so that edges between collapsed cells can be merged.
+        bool clustered = g_SpaceResources->AutoLOD && m_RenderMode == NODE_RENDERING;
+        SpaceClusterCollector collector;
+        if (clustered)
+        {
+            float pixelScale = 0.5f * getViewport().getDimension()[1] * m_Camera.getProjectionMatrix()[1][1];
+            m_Octree.foreachClustersInsideFrustum(frustum, m_Camera.getPosition(), pixelScale, g_SpaceResources->AutoLODThreshold, &collector);
+
+            std::vector<long> collapsed;
+            collapsed.reserve(collector.Clusters.size());
+            for (auto& cluster : collector.Clusters)
+                collapsed.push_back(cluster.Cell);
+
+            m_MetaEdges.update(m_Octree, collapsed, m_SpaceEdges, m_NodeEdges);
+        }
+        else
+        {
+            m_MetaEdges.reset(m_SpaceEdges);
+        }
+        m_Octree.clearChanged();
+
+        // Draw Edges
+        if (g_SpaceResources->ShowEdges || g_SpaceResources->ShowEdgeActivity)
+        {
+            #ifndef EMSCRIPTEN
+                // NOTE : Not supported by WebGL
+                RenderState::getInstance().enable(GL_LINE_SMOOTH);
+                glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+            #endif
+
+            m_EdgeBatch.draw(context(), m_Camera.getViewProjectionMatrix() * transformation.state());
+            m_MetaEdges.draw(context(), m_Octree, m_SpaceNodes, m_Camera.getViewProjectionMatrix() * transformation.state());
+        }
+
+        // NOTE : Labels are only placed for the nodes found by the frustum traversal of the node pass
+        bool labels = g_SpaceResources->ShowNodeLabels && m_RenderMode != DENSITY_RENDERING;
+        m_VisibleNodes.clear();
+
         // Draw Nodes
         {
-             if (m_Octree == NULL || m_DirtyOctree)
-             {
-                 m_SpaceNodes.draw(context(), m_Camera.getProjectionMatrix(), m_Camera.getViewMatrix(), transformation.state());
- 
-                 // Draw Edges
-                 if (g_SpaceResources->ShowEdges || g_SpaceResources->ShowEdgeActivity)
-                 {
-                    #ifndef EMSCRIPTEN
-                        // NOTE : Not supported by WebGL
-                        glEnable(GL_LINE_SMOOTH);
-                        glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
-                    #endif
+             SpaceRenderer renderer(context(), &m_Camera, &transformation, &m_SpaceNodes, labels ? &m_VisibleNodes : NULL);
 
-                     m_SpaceEdges.draw(context(), m_Camera.getProjectionMatrix(), m_Camera.getViewMatrix(), transformation.state());
-                 }
+             if (m_RenderMode == DENSITY_RENDERING)
+             {
+                 m_Density.draw(m_Camera, getViewport().getDimension(), transformation.state());
+             }
+             else if (clustered)
+             {
+                 collector.replay(&renderer);
              }
              else
              {
-                 static int pass = 0;
-                 pass = (pass + 1) % 2;
-                 SpaceRenderer renderer(context(), &m_Camera, &transformation, pass);
-                 Frustrum frustrum(m_Camera.getViewProjectionMatrix());
-                 m_Octree->foreachElementsInsideFrustrum(frustrum, &renderer);
- 
-                 static int drawCount = 0;
-                 if (drawCount != renderer.getDrawCount())
+                 m_Octree.foreachElementsInsideFrustum(frustum, &renderer);
+             }
+
+             if (m_RenderMode != DENSITY_RENDERING)
+             {
+                 Stats::getInstance().visible(renderer.getNodeCount());
+                 Stats::getInstance().culled(m_Octree.size() - renderer.getNodeCount());
+             }
+
+             static int drawCount = 0;
+             if (drawCount != renderer.getDrawCount())
+             {
+                 drawCount  = renderer.getDrawCount();
+                 if (g_SpaceResources->ShowDebug)
                  {
-                     drawCount  = renderer.getDrawCount();
-                     if (g_SpaceResources->ShowDebug)
-                     {
-                         LOG("[DEBUG] %i elements drawn.\n", drawCount);
-                     }
+                     LOG("[DEBUG] %i elements drawn (%i clusters), %lu octree cells.\n", drawCount, renderer.getClusterCount(), m_Octree.countCells());
                  }
- 
-                 if (g_SpaceResources->ShowDebug)
-                     m_Octree->draw(context(), m_Camera.getProjectionMatrix(), m_Camera.getViewMatrix(), transformation.state());
              }
- 
+
              std::set<Node::ID>::iterator iti;
              for (iti = model()->selectedNodes_begin(); iti != model()->selectedNodes_end(); ++iti)
              {
@@ -320,35 +426,30 @@ class SpaceView : public GraphView
                  glm::mat4 modelView = m_Camera.getViewMatrix() * glm::translate(transformation.state(), m_SpaceNodes[selectedID]->getPosition());
                  modelView = glm::scale(Geometry::billboard(modelView), glm::vec3(iconSize, iconSize, iconSize));
                  g_SpaceResources->NodeTargetIcon->draw(context(), m_Camera.getProjectionMatrix() * modelView, glm::vec4(1.0, 1.0, 1.0, 1.0), 0);
+                 Stats::getInstance().drawCall(2);
              }
-        }
 
-        // Draw spheres
-        if (g_SpaceResources->ShowSpheres)
-            m_SpaceSpheres.draw(context(), m_Camera.getProjectionMatrix(), m_Camera.getViewMatrix(), transformation.state());
-    }
- 
-    void computeBoundingSphere(Sphere& sphere, glm::vec3* center, float* radius)
-    {
-        glm::vec3 barycenter = glm::vec3(0, 0, 0);
-        float r = 1.0;
+             // NOTE : Node icons are drawn by the engine
+             RenderState::getInstance().invalidate();
+        }
 
-        for (unsigned int n = 0; n < sphere.data().Nodes.size(); n++)
+        // Draw Labels
+        if (labels)
         {
-            barycenter = barycenter + m_SpaceNodes[sphere.data().Nodes[n]]->getPosition() / (float) sphere.data().Nodes.size();
+            m_Labels.draw(context(), m_SpaceNodes, m_VisibleNodes, m_Camera, getViewport().getDimension(), transformation.state());
+            RenderState::getInstance().invalidate();
         }
 
-        for (unsigned int n = 0; n < sphere.data().Nodes.size(); n++)
+        // Draw spheres
+        if (g_SpaceResources->ShowSpheres)
         {
-            float length = glm::length(barycenter - m_SpaceNodes[sphere.data().Nodes[n]]->getPosition());
-            if (length > r)
-                r = length;
+            m_SpaceSpheres.draw(context(), m_Camera.getProjectionMatrix(), m_Camera.getViewMatrix(), transformation.state());
+            RenderState::getInstance().invalidate();
         }
 
-        *radius = r;
-        *center = barycenter;
+        m_DrawnViewProjection = m_Camera.getViewProjectionMatrix();
     }
-
+ 
     SpaceNode::ID pushNodeVertexAround(Node::ID uid, const char* label, glm::vec3 position, float radius)
     {
         float rnd1 = (float) rand();
@@ -364,6 +465,8 @@ class SpaceView : public GraphView
 
         m_NodeMap.addRemoteID(uid, vid);
 
+        updateNode(vid);
+
         return vid;
     }
 
@@ -389,63 +492,72 @@ class SpaceView : public GraphView
 
     bool pickNode(int x, int y, SpaceNode::ID* id)
     {
-        Ray ray = m_Camera.createRay(x, y);
-
-        Intersection::Hit hit;
-        bool found = false;
-        glm::vec3 position;
+        if (m_PickingMode == GPU_PICKING)
+        {
+            Transformation transformation;
+            return m_Picker.pick(x, y, m_Camera, getViewport().getDimension(), transformation.state(), id);
+        }
 
-        float min_distance = std::numeric_limits<float>::max();
+        Ray ray = m_Camera.createRay(x, y);
 
-        for (unsigned int i = 0; i < m_SpaceNodes.size(); i++)
-        {
-            if (m_SpaceNodes[i] == NULL)
-                continue;
+        SpacePickingFilter filter(&m_SpaceNodes);
+        return m_Octree.intersectRay(ray.position(), ray.direction(), &filter, id, NULL);
+    }
 
-            SpaceNode* spaceNode = static_cast<SpaceNode*>(m_SpaceNodes[i]);
+    void setPickingMode(PickingMode mode)
+    {
+        if (mode == m_PickingMode)
+            return;
 
-             if (!g_SpaceResources->isNodeVisible(spaceNode->getLOD()))
-                 continue;
+        m_PickingMode = mode;
 
-             position = m_SpaceNodes[i]->getPosition();
+        // NOTE : The ID buffer is only maintained while GPU picking is active
+        m_Picker.clear();
+        if (m_PickingMode == GPU_PICKING)
+            updateOctree();
+    }
 
-            float pickRadius = g_SpaceResources->NodeIconSize * spaceNode->getSize() / 2.0f;
+    void setRenderMode(RenderMode mode)
+    {
+        if (mode == m_RenderMode)
+            return;
 
-            if (Intersection::RaySphere(ray, position, pickRadius, hit))
-            {
-                if (id == NULL)
-                    return true;
+        m_RenderMode = mode;
 
-                if (hit.distance < min_distance)
-                {
-                    *id = i;
-                    min_distance = hit.distance;
-                }
+        // NOTE : The density points are only maintained while the density mode is active
+        m_Density.clear();
+        if (m_RenderMode == DENSITY_RENDERING)
+            updateOctree();
+    }
 
-                found = true;
-            }
-        }
+    // NOTE : The frame only needs to be drawn again when the camera moved, the graph changed or something is animated.
+    bool needsRedraw() override
+    {
+        if (m_Invalidated.load() || m_CameraAnimation)
+            return true;
+        if (m_PhysicsMode == PLAY && m_Iterations >= 1)
+            return true;
+        if (g_SpaceResources->ShowNodeActivity && m_ActiveNodeCount > 0)
+            return true;
+        if (g_SpaceResources->ShowEdgeActivity && m_EdgeBatch.hasActivity())
+            return true;
+
+        return m_Camera.getViewProjectionMatrix() != m_DrawnViewProjection;
+    }
 
-        return found;
+    void step() override
+    {
+        updateNodes();
     }
 
     void idle() override
     {
-        updateNodes();
+        if (NodeCompaction::needed(m_SpaceNodes.size(), m_NodeMap.count()) || NodeCompaction::needed(m_SpaceEdges.size(), m_LinkMap.count()))
+            compact();
+
         updateLinks();
         updateSpheres();
 
-        // NOTE : We use the octree when we are not running the physics.
-        // In the future, we will dynamically update the octree as the objects move inside it.
-        if (m_PhysicsMode == PAUSE)
-        {
-            updateOctree();
-        }
-        else
-        {
-            SAFE_DELETE(m_Octree);
-        }
-
         if (m_CameraAnimation)
         {
             float time = context()->sequencer().track("animation")->clock().seconds();
@@ -460,6 +572,8 @@ class SpaceView : public GraphView
 
     void updateNodes()
     {
+        PROFILE_ZONE("SpaceView::updateNodes");
+
         const unsigned int c_MaxIterations = 100;
         bool c_Loop = true;
 
@@ -476,15 +590,19 @@ class SpaceView : public GraphView
             if (itn != NULL)
                 itn->setDirection(glm::vec3(0, 0, 0), false);
 
-        // Calculate graph forces
-        m_NodeRepulsionForce.apply(m_SpaceNodes);
-        m_LinkAttractionForce.apply(m_SpaceNodes, m_SpaceEdges);
-        m_DustAttractor.apply(m_SpaceNodes);
-        // m_GravitationForce.apply(m_SpaceNodes);
+        {
+            Stats::Timer timer(Stats::LAYOUT);
+
+            // Calculate graph forces
+            m_NodeRepulsionForce.apply(m_SpaceNodes);
+            m_LinkAttractionForce.apply(m_SpaceNodes, m_SpaceEdges);
+            m_DustAttractor.apply(m_SpaceNodes);
+            // m_GravitationForce.apply(m_SpaceNodes);
 
-        m_SpaceNodes.normalizeDirections();
-        m_SpaceNodes.randomizeDirections();
-        m_SpaceNodes.update();
+            m_SpaceNodes.normalizeDirections();
+            m_SpaceNodes.randomizeDirections();
+            m_SpaceNodes.update();
+        }
 
         if (!c_Loop)
         {
@@ -493,111 +611,146 @@ class SpaceView : public GraphView
         }
 
         m_Iterations++;
-        m_DirtyOctree = true;
+
+        updateOctree();
     }
 
+    // NOTE : Only the edges marked since the last call are updated, a static graph costs nothing here.
+    // Edges keep waiting while they are hidden.
     void updateLinks()
     {
-        if (g_SpaceResources->ShowEdges || g_SpaceResources->ShowEdgeActivity)
+        if (!g_SpaceResources->ShowEdges && !g_SpaceResources->ShowEdgeActivity)
+            return;
+
+        for (auto id : m_DirtyEdges)
         {
-            for (auto it : m_SpaceEdges)
-                if (it != NULL)
-                    static_cast<SpaceEdge*>(it)->update();
+            if (id >= m_SpaceEdges.size() || m_SpaceEdges[id] == NULL)
+                continue;
+
+            SpaceEdge* edge = static_cast<SpaceEdge*>(m_SpaceEdges[id]);
+            edge->setQueued(false);
+            edge->update();
         }
+
+        m_DirtyEdges.clear();
     }
 
-    void updateSpheres()
+    inline void markEdge(SpaceEdge::ID id)
     {
-        glm::vec3 position;
-        float radius;
+        SpaceEdge* edge = static_cast<SpaceEdge*>(m_SpaceEdges[id]);
+        if (edge == NULL || edge->isQueued())
+            return;
 
-        std::vector<Sphere>::iterator its;
-        for (its = model()->spheres_begin(); its != model()->spheres_end(); ++its)
-        {
-            if (m_SpaceSpheres[its->id()] != NULL)
-            {
-                computeBoundingSphere(*its, &position, &radius);
-                m_SpaceSpheres[its->id()]->setPosition(position);
-                static_cast<SpaceSphere*>(m_SpaceSpheres[its->id()])->setRadius(radius);
-            }
-        }
+        edge->setQueued(true);
+        m_DirtyEdges.push_back(id);
     }
 
-    void updateOctree()
+    inline void markNodeEdges(SpaceNode::ID id)
     {
-        if (!m_DirtyOctree)
+        if (id >= m_NodeEdges.size())
             return;
 
-        if (g_SpaceResources->ShowDebug)
-        {
-            LOG("[SPACE] Updating octree ...\n");
-            LOG("[SPACE] . Calculating bounding box ...\n");
-        }
+        for (auto edge : m_NodeEdges[id])
+            markEdge(edge);
+    }
 
-        glm::vec3 min;
-        glm::vec3 max;
+    void markAllEdges()
+    {
+        for (unsigned long i = 0; i < m_SpaceEdges.size(); i++)
+            if (m_SpaceEdges[i] != NULL)
+                markEdge(i);
+    }
 
-        unsigned long count = 0;
+    // NOTE : Only the spheres whose members moved, joined or left are refit
+    void updateSpheres()
+    {
+        if (m_SphereBounds.update(m_SpaceNodes, m_SpaceSpheres) && g_SpaceResources->ShowSpheres)
+            invalidate();
+    }
 
-        for (unsigned long i = 0; i < m_SpaceNodes.size(); i++)
-        {
-            if (m_SpaceNodes[i] == NULL)
-                continue;
+    inline float getNodeRadius(SpaceNode* node) { return node->getScreenSize() / 2.0f; }
 
-            if (count == 0)
-            {
-                min = max = m_SpaceNodes[i]->getPosition();
-                count++;
-                continue;
-            }
+    // NOTE : Must be called whenever a node position, color or size is changed outside of the graph events.
+    void updateNode(SpaceNode::ID id)
+    {
+        invalidate();
 
-            glm::vec3 pos = m_SpaceNodes[i]->getPosition();
+        SpaceNode* node = static_cast<SpaceNode*>(m_SpaceNodes[id]);
+        m_Octree.move(id, node->getPosition(), getNodeRadius(node), node->getColor());
+        m_SphereBounds.move(id);
+        markNodeEdges(id);
 
-            for (int i = 0; i < 3; i++)
-                min[i] = pos[i] < min[i] ? pos[i] : min[i];
-            for (int i = 0; i < 3; i++)
-                max[i] = pos[i] > max[i] ? pos[i] : max[i];
+        if (m_PickingMode == GPU_PICKING)
+            m_Picker.update(id, node->getPosition(), getNodeRadius(node), node->getLOD());
+        if (m_RenderMode == DENSITY_RENDERING)
+            m_Density.update(id, node->getPosition(), node->getLOD());
+    }
 
-            count++;
-        }
+    void updateOctree()
+    {
+        PROFILE_ZONE("SpaceView::updateOctree");
+        Stats::Timer timer(Stats::OCTREE);
 
-        SAFE_DELETE(m_Octree);
+        for (unsigned long i = 0; i < m_SpaceNodes.size(); i++)
+            if (m_SpaceNodes[i] != NULL)
+                updateNode(i);
+    }
 
-        if (count == 0)
-        {
-            if (g_SpaceResources->ShowDebug)
-            {
-                LOG("[SPACE] . Graph is empty! Aborting.\n");
-            }
-            m_DirtyOctree = false;
+    // NOTE : Packs the node and edge vectors after removals and remaps everything indexed by local IDs.
+    // The spatial structures are rebuilt from scratch.
+    void compact()
+    {
+        PROFILE_ZONE("SpaceView::compact");
+
+        // NOTE : Merged edges are tracked by edge ID, they're restored while the IDs still match
+        m_MetaEdges.reset(m_SpaceEdges);
+
+        std::vector<unsigned long> nodeRemap;
+        std::vector<unsigned long> edgeRemap;
+        unsigned long nodeCount = NodeCompaction::pack(m_SpaceNodes, nodeRemap);
+        unsigned long edgeCount = NodeCompaction::pack(m_SpaceEdges, edgeRemap);
+
+        if (nodeCount == nodeRemap.size() && edgeCount == edgeRemap.size())
             return;
-        }
 
-        if (g_SpaceResources->ShowDebug)
-        {
-            LOG("[SPACE]   . Min : (%f, %f, %f)\n", min.x, min.y, min.z);
-            LOG("[SPACE]   . Max : (%f, %f, %f)\n", max.x, max.y, max.z);
-        }
+        LOG("[SPACE] Compaction : %lu nodes (%lu holes), %lu edges (%lu holes)\n",
+            nodeCount, nodeRemap.size() - nodeCount, edgeCount, edgeRemap.size() - edgeCount);
 
-        m_Octree = new Octree(min, max);
+        for (unsigned long i = 0; i < nodeCount; i++)
+            static_cast<SpaceNode*>(m_SpaceNodes[i])->setID(i);
 
-        for (unsigned long i = 0; i < m_SpaceNodes.size(); i++)
-        {
-            if (m_SpaceNodes[i] != NULL)
-            m_Octree->insert(m_SpaceNodes[i]);
-        }
-        for (unsigned long i = 0; i < m_SpaceEdges.size(); i++)
+        m_NodeMap.remapLocalIDs(nodeRemap);
+        m_LinkMap.remapLocalIDs(edgeRemap);
+        m_SphereBounds.remap(nodeRemap);
+
+        std::vector< std::vector<SpaceEdge::ID> > nodeEdges(nodeCount);
+        for (unsigned long i = 0; i < m_NodeEdges.size() && i < nodeRemap.size(); i++)
         {
-            if (m_SpaceEdges[i] != NULL)
-            m_Octree->insert(m_SpaceEdges[i]);
-        }
+            if (nodeRemap[i] == NodeCompaction::Invalid)
+                continue;
 
-        m_DirtyOctree = false;
+            std::vector<SpaceEdge::ID>& edges = nodeEdges[nodeRemap[i]];
+            edges.swap(m_NodeEdges[i]);
+            for (auto& edge : edges)
+                edge = edgeRemap[edge];
+        }
+        m_NodeEdges.swap(nodeEdges);
+
+        std::vector<SpaceEdge::ID> dirtyEdges;
+        for (auto edge : m_DirtyEdges)
+            if (edge < edgeRemap.size() && edgeRemap[edge] != NodeCompaction::Invalid)
+                dirtyEdges.push_back(edgeRemap[edge]);
+        m_DirtyEdges.swap(dirtyEdges);
+
+        m_Octree.clear();
+        m_Picker.clear();
+        m_Density.clear();
+        updateOctree();
     }
 
     inline Camera* camera() { return &m_Camera; }
 
-    inline void setNodeSize(float size) { g_SpaceResources->NodeIconSize = size; }
+    inline void setNodeSize(float size) { g_SpaceResources->NodeIconSize = size; updateOctree(); }
     inline void setEdgeSize(float size) { g_SpaceResources->EdgeSize = size; }
     inline void setTemperature(float temperature) { LOG("Temperature : %f\n", temperature); m_Temperature = temperature; }
 
@@ -622,6 +775,8 @@ class SpaceView : public GraphView
 
     void onSetAttribute(const std::string& name, VariableType type, const std::string& value) override
     {
+        invalidate();
+
         FloatVariable vfloat;
         Vec3Variable vvec3;
         StringVariable vstring;
@@ -643,6 +798,7 @@ class SpaceView : public GraphView
                 g_SpaceResources->m_LinkMode = SpaceResources::NODE_COLOR;
             else if (value == "link_color")
                 g_SpaceResources->m_LinkMode = SpaceResources::LINK_COLOR;
+            markAllEdges();
         }
         else if (name == "space:camera:position" && type == RD_VEC3)
         {
@@ -660,44 +816,108 @@ class SpaceView : public GraphView
             vbool.set(value);
             g_SpaceResources->ShowDebug = vbool.value();
         }
+        else if (name == "space:picking" && type == RD_STRING)
+        {
+            vstring.set(value);
+            if (vstring.value() == "gpu")
+                setPickingMode(GPU_PICKING);
+            else if (vstring.value() == "octree")
+                setPickingMode(OCTREE_PICKING);
+        }
+        else if (name == "space:render:mode" && type == RD_STRING)
+        {
+            vstring.set(value);
+            if (vstring.value() == "density")
+                setRenderMode(DENSITY_RENDERING);
+            else if (vstring.value() == "nodes")
+                setRenderMode(NODE_RENDERING);
+        }
+        else if (name == "space:render:kernel" && type == RD_FLOAT)
+        {
+            vfloat.set(value);
+            m_Density.KernelSize = vfloat.value();
+        }
+        else if (name == "space:render:range" && type == RD_FLOAT)
+        {
+            vfloat.set(value);
+            m_Density.Range = vfloat.value();
+        }
+        else if (name == "space:lod:auto" && type == RD_BOOLEAN)
+        {
+            vbool.set(value);
+            g_SpaceResources->AutoLOD = vbool.value();
+        }
+        else if (name == "space:lod:threshold" && type == RD_FLOAT)
+        {
+            vfloat.set(value);
+            g_SpaceResources->AutoLODThreshold = vfloat.value();
+        }
+        else if (name == "space:labels:minsize" && type == RD_FLOAT)
+        {
+            vfloat.set(value);
+            m_Labels.MinimumSize = vfloat.value();
+        }
+        else if (name == "space:compact" && type == RD_BOOLEAN)
+        {
+            compact();
+        }
+    }
+
+    void onReserve(unsigned long nodes, unsigned long links) override
+    {
+        SpaceNode::reserve(nodes);
+        SpaceEdge::reserve(links);
     }
 
     void onAddNode(Node::ID uid, const char* label) override
     {
+        invalidate();
+
         pushNodeVertexAround(uid, label, glm::vec3(0, 0, 0), 2);
-        m_DirtyOctree = true;
     }
 
     void onRemoveNode(Node::ID uid) override
     {
+        invalidate();
+
         checkNodeUID(uid);
 
         SpaceNode::ID vid = m_NodeMap.getLocalID(uid);
 
-        for (unsigned int i = 0; i < m_SpaceEdges.size(); i++)
+        // NOTE : Only the edges of the node are visited, through the adjacency
+        std::vector<SpaceEdge::ID> edges;
+        if (vid < m_NodeEdges.size())
+            edges.swap(m_NodeEdges[vid]);
+
+        for (auto i : edges)
         {
-            if (m_SpaceEdges[i] != NULL)
-            {
-                SpaceEdge* link = static_cast<SpaceEdge*>(m_SpaceEdges[i]);
+            // NOTE : Self-loops are listed twice
+            if (m_SpaceEdges[i] == NULL)
+                continue;
 
-                if (link->getNode1() == vid || link->getNode2() == vid)
-                {
-                    m_SpaceEdges.remove(i);
-                    m_LinkMap.removeLocalID(i);
-                }
-            }
+            SpaceEdge* link = static_cast<SpaceEdge*>(m_SpaceEdges[i]);
+            m_MetaEdges.onRemoveEdge(i);
+            unlinkNodeEdge(link->getNode1() == vid ? link->getNode2() : link->getNode1(), i);
+            m_SpaceEdges.remove(i);
+            m_LinkMap.removeLocalID(i);
         }
 
-        // TODO : Remove node from spheres here
+        m_SphereBounds.remove(vid);
+
+        if (static_cast<SpaceNode*>(m_SpaceNodes[vid])->getActivity() > 0.0f)
+            m_ActiveNodeCount--;
 
+        m_Octree.remove(vid);
+        m_Picker.remove(vid);
+        m_Density.remove(vid);
         m_SpaceNodes.remove(vid);
         m_NodeMap.eraseRemoteID(uid, vid);
-
-        m_DirtyOctree = true;
     }
 
     void onSetNodeAttribute(Node::ID uid, const std::string& name, VariableType type, const std::string& value) override
     {
+        invalidate();
+
         FloatVariable vfloat;
         BooleanVariable vbool;
         StringVariable vstring;
@@ -717,7 +937,7 @@ class SpaceView : public GraphView
         {
             vvec3.set(value);
             m_SpaceNodes[id]->setPosition(vvec3.value());
-            m_DirtyOctree = true;
+            updateNode(id);
         }
         else if (name == "space:color" && (type == RD_VEC3 || type == RD_VEC4))
         {
@@ -734,16 +954,20 @@ class SpaceView : public GraphView
                 c = vvec4.value();
             }
             static_cast<SpaceNode*>(m_SpaceNodes[id])->setColor(c);
+            updateNode(id);
         }
         else if (name == "space:lod" && type == RD_FLOAT)
         {
              vfloat.set(value);
              m_SpaceNodes[id]->setLOD(vfloat.value());
+             updateNode(id);
         }
         else if (name == "space:activity" && type == RD_FLOAT)
          {
              vfloat.set(value);
-             static_cast<SpaceNode*>(m_SpaceNodes[id])->setActivity(vfloat.value());
+             SpaceNode* node = static_cast<SpaceNode*>(m_SpaceNodes[id]);
+             m_ActiveNodeCount += (vfloat.value() > 0.0f ? 1 : 0) - (node->getActivity() > 0.0f ? 1 : 0);
+             node->setActivity(vfloat.value());
          }
         else if (name == "space:icon" && type == RD_STRING)
          {
@@ -759,11 +983,14 @@ class SpaceView : public GraphView
          {
              vfloat.set(value);
              static_cast<SpaceNode*>(m_SpaceNodes[id])->setSize(vfloat.value());
+             updateNode(id);
          }
     }
  
     void onSetNodeLabel(Node::ID uid, const char* label) override
     {
+        invalidate();
+
         checkNodeUID(uid);
 
         SpaceNode::ID id = m_NodeMap.getLocalID(uid);
@@ -773,38 +1000,53 @@ class SpaceView : public GraphView
 
     void onTagNode(Node::ID node, Sphere::ID sphere) override
     {
-        (void) node;
-        (void) sphere;
+        invalidate();
+
+        checkNodeUID(node);
+
+        SpaceNode::ID vid = m_NodeMap.getLocalID(node);
+        m_SphereBounds.tag(vid, sphere, m_SpaceNodes[vid]->getPosition());
     }
 
     void onAddLink(Link::ID uid, Node::ID uid1, Node::ID uid2) override
     {
+        invalidate();
+
         checkNodeUID(uid1);
         checkNodeUID(uid2);
 
         SpaceNode::ID node1 = m_NodeMap.getLocalID(uid1);
         SpaceNode::ID node2 = m_NodeMap.getLocalID(uid2);
 
-        SpaceEdge::ID lid = m_SpaceEdges.add(new SpaceEdge(m_SpaceNodes[node1], m_SpaceNodes[node2]));
+        SpaceEdge::ID lid = m_SpaceEdges.add(new SpaceEdge(&m_EdgeBatch, m_SpaceNodes[node1], m_SpaceNodes[node2]));
+        linkNodeEdge(node1, lid);
+        linkNodeEdge(node2, lid);
+        m_MetaEdges.onAddEdge(m_Octree, m_SpaceEdges, lid);
 
         m_LinkMap.addRemoteID(uid, lid);
-        m_DirtyOctree = true;
     }
 
     void onRemoveLink(Link::ID uid) override
     {
+        invalidate();
+
         checkLinkUID(uid);
 
         SpaceEdge::ID vid = m_LinkMap.getLocalID(uid);
 
+        SpaceEdge* edge = static_cast<SpaceEdge*>(m_SpaceEdges[vid]);
+        m_MetaEdges.onRemoveEdge(vid);
+        unlinkNodeEdge(edge->getNode1(), vid);
+        unlinkNodeEdge(edge->getNode2(), vid);
+
         m_SpaceEdges.remove(vid);
         m_LinkMap.eraseRemoteID(uid, vid);
-
-        m_DirtyOctree = true;
     }
 
     void onSetLinkAttribute(Link::ID uid, const std::string& name, VariableType type, const std::string& value) override
     {
+        invalidate();
+
         checkLinkUID(uid);
 
         FloatVariable vfloat;
@@ -876,27 +1118,56 @@ class SpaceView : public GraphView
             vfloat.set(value);
             static_cast<SpaceEdge*>(m_SpaceEdges[id])->setWidth(vfloat.value());
         }
+
+        markEdge(id);
     }
 
     void onAddSphere(Sphere::ID id, const char* label) override
     {
-        (void) id;
+        invalidate();
+
         (void) label;
         m_SpaceSpheres.add(new SpaceSphere());
+        m_SphereBounds.addSphere(id);
     }
 
     void onAddNeighbor(const std::pair<Node::ID, Link::ID>& element, const char* label, Node::ID neighbor) override
     {
+        invalidate();
+
         checkNodeUID(neighbor);
 
         SpaceNode::ID nid = m_NodeMap.getLocalID(neighbor);
 
         SpaceNode::ID vid = pushNodeVertexAround(element.first, label, m_SpaceNodes[nid]->getPosition(), 2);
-        SpaceEdge::ID lid = m_SpaceEdges.add(new SpaceEdge(m_SpaceNodes[nid], m_SpaceNodes[vid]));
+        SpaceEdge::ID lid = m_SpaceEdges.add(new SpaceEdge(&m_EdgeBatch, m_SpaceNodes[nid], m_SpaceNodes[vid]));
+        linkNodeEdge(nid, lid);
+        linkNodeEdge(vid, lid);
+        m_MetaEdges.onAddEdge(m_Octree, m_SpaceEdges, lid);
 
         m_LinkMap.addRemoteID(element.second, lid);
+    }
+
+    // NOTE : Node to edges adjacency, used to reassign the edges of the nodes whose cluster collapsed or expanded.
+    void linkNodeEdge(SpaceNode::ID node, SpaceEdge::ID edge)
+    {
+        if (node >= m_NodeEdges.size())
+            m_NodeEdges.resize(node + 1);
+        m_NodeEdges[node].push_back(edge);
+    }
+
+    void unlinkNodeEdge(SpaceNode::ID node, SpaceEdge::ID edge)
+    {
+        if (node >= m_NodeEdges.size())
+            return;
 
-        m_DirtyOctree = true;
+        std::vector<SpaceEdge::ID>& edges = m_NodeEdges[node];
+        auto it = std::find(edges.begin(), edges.end(), edge);
+        if (it != edges.end())
+        {
+            *it = edges.back();
+            edges.pop_back();
+        }
     }
 
     // -----
@@ -923,12 +1194,26 @@ class SpaceView : public GraphView
     NodeTranslationMap m_NodeMap;
     LinkTranslationMap m_LinkMap;
 
+    SpaceEdgeBatch m_EdgeBatch; // NOTE : Declared before the edges so that it outlives them
     Scene::NodeVector m_SpaceNodes;
     Scene::NodeVector m_SpaceEdges;
     Scene::NodeVector m_SpaceSpheres;
-
-    Octree* m_Octree;
-    bool m_DirtyOctree;
+    SpaceSphereBounds m_SphereBounds;
+
+    SpaceOctree m_Octree;
+    SpaceMetaEdges m_MetaEdges;
+    std::vector< std::vector<SpaceEdge::ID> > m_NodeEdges;
+    std::vector<SpaceEdge::ID> m_DirtyEdges;
+    SpacePicker m_Picker;
+    PickingMode m_PickingMode;
+    SpaceDensity m_Density;
+    RenderMode m_RenderMode;
+
+    SpaceLabels m_Labels;
+    std::vector<SpaceOctree::ID> m_VisibleNodes;
+
+    unsigned long m_ActiveNodeCount;
+    glm::mat4 m_DrawnViewProjection;
 
     PhysicsMode m_PhysicsMode;
     unsigned int m_Iterations;
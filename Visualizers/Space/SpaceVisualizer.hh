@@ -38,6 +38,8 @@ public:
 
         set(view);
         set(controller);
+        listen(entity, view);
+        listen(entity, controller);
 
         return true;
     }
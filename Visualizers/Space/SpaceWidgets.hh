@@ -629,7 +629,7 @@ public:
 
 	virtual void draw(Context* context)
 	{
-		glBlendFunc(GL_SRC_ALPHA, GL_DST_ALPHA);
+		RenderState::getInstance().blendFunc(GL_SRC_ALPHA, GL_DST_ALPHA);
         m_TopLeftWidgetGroup->draw(context, glm::mat4(), m_Camera.getViewMatrix(), m_Camera.getProjectionMatrix());
         m_BottomLeftWidgetGroup->draw(context, glm::mat4(), m_Camera.getViewMatrix(), m_Camera.getProjectionMatrix());
         m_BottomRightWidgetGroup->draw(context, glm::mat4(), m_Camera.getViewMatrix(), m_Camera.getProjectionMatrix());
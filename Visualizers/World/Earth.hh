@@ -2,7 +2,10 @@
 
 #include <raindance/Core/Scene/Node.hh>
 
-class EarthGeoPoint : public Scene::Node
+#include "Core/NodeCompaction.hh"
+#include "Core/ObjectPool.hh"
+
+class EarthGeoPoint : public Scene::Node, public Pooled<EarthGeoPoint>
 {
 public:
     typedef unsigned long ID;
@@ -19,6 +22,8 @@ public:
 
 	void draw(Context* context, const glm::mat4& projection, const glm::mat4& view, const glm::mat4& model)
 	{
+		(void) projection;
+
 		g_WorldResources->EarthGeoPointMaterial.setDiffuse(m_Color);
 		g_WorldResources->EarthGeoPointMaterial.setShininess(100.0f);
 
@@ -26,23 +31,21 @@ public:
 		transformation.set(model * getModelMatrix());
 		transformation.scale(glm::vec3(g_WorldResources->EarthNodeSize, m_Size, g_WorldResources->EarthNodeSize));
 
-		g_WorldResources->EarthGeoPointShader->use();
-		g_WorldResources->EarthGeoPointShader->uniform("u_ModelMatrix").set(transformation.state());
-		g_WorldResources->EarthGeoPointShader->uniform("u_ViewMatrix").set(view);
-		g_WorldResources->EarthGeoPointShader->uniform("u_ProjectionMatrix").set(projection);
+		// NOTE : View, projection and sun come from the shared frame uniforms
+		UniformCache& uniforms = g_WorldResources->EarthGeoPointUniforms;
+
+		RenderState::getInstance().use(g_WorldResources->EarthGeoPointShader);
+		uniforms.bind();
+		uniforms.set(g_WorldResources->Frame);
+		uniforms.set(g_WorldResources->EarthGeoPointModel, transformation.state());
 		// NOTE : Normal Matrix is the transpose of the inverse of the model view matrix
 		// Using the Model View Matrix doesn't work if using non-homogeneous scales
-		g_WorldResources->EarthGeoPointShader->uniform("u_NormalMatrix").set(glm::transpose(glm::inverse(glm::mat3(view * transformation.state()))));
-
-		g_WorldResources->EarthGeoPointShader->uniform("u_Light.Type").set(g_WorldResources->Sun.getType());
-		g_WorldResources->EarthGeoPointShader->uniform("u_Light.Position").set(g_WorldResources->Sun.getPosition());
-		g_WorldResources->EarthGeoPointShader->uniform("u_Light.Direction").set(g_WorldResources->Sun.getDirection());
-		g_WorldResources->EarthGeoPointShader->uniform("u_Light.Color").set(g_WorldResources->Sun.getColor());
+		uniforms.set(g_WorldResources->EarthGeoPointNormal, glm::transpose(glm::inverse(glm::mat3(view * transformation.state()))));
 
-		g_WorldResources->EarthGeoPointShader->uniform("u_Material.Ambient").set(g_WorldResources->EarthGeoPointMaterial.getAmbient());
-		g_WorldResources->EarthGeoPointShader->uniform("u_Material.Diffuse").set(g_WorldResources->EarthGeoPointMaterial.getDiffuse());
-		g_WorldResources->EarthGeoPointShader->uniform("u_Material.Specular").set(g_WorldResources->EarthGeoPointMaterial.getSpecular());
-		g_WorldResources->EarthGeoPointShader->uniform("u_Material.Shininess").set(g_WorldResources->EarthGeoPointMaterial.getShininess());
+		uniforms.set(g_WorldResources->EarthGeoPointAmbient, g_WorldResources->EarthGeoPointMaterial.getAmbient());
+		uniforms.set(g_WorldResources->EarthGeoPointDiffuse, g_WorldResources->EarthGeoPointMaterial.getDiffuse());
+		uniforms.set(g_WorldResources->EarthGeoPointSpecular, g_WorldResources->EarthGeoPointMaterial.getSpecular());
+		uniforms.set(g_WorldResources->EarthGeoPointShininess, g_WorldResources->EarthGeoPointMaterial.getShininess());
 
 		context->geometry().bind(g_WorldResources->EarthGeoCube->getVertexBuffer(), *g_WorldResources->EarthGeoPointShader);
 		context->geometry().drawElements(GL_TRIANGLES, g_WorldResources->EarthGeoCube->getTriangleBuffer().size() / sizeof(short int), GL_UNSIGNED_SHORT, g_WorldResources->EarthGeoCube->getTriangleBuffer().ptr());
@@ -70,7 +73,7 @@ private:
     float m_Size;
 };
 
-class EarthGeoLink : public Scene::Node
+class EarthGeoLink : public Scene::Node, public Pooled<EarthGeoLink>
 {
 public:
     typedef unsigned long ID;
@@ -123,9 +126,12 @@ public:
 
     void draw(Context* context, const glm::mat4& projection, const glm::mat4& view, const glm::mat4& model)
     {
-        g_WorldResources->EarthGeoLinkShader->use();
-        g_WorldResources->EarthGeoLinkShader->uniform("u_ModelViewProjection").set(projection * view * model);
-        g_WorldResources->EarthGeoLinkShader->uniform("u_Tint").set(glm::vec4(1.0, 1.0, 1.0, 1.0));
+        UniformCache& uniforms = g_WorldResources->EarthGeoLinkUniforms;
+
+        RenderState::getInstance().use(g_WorldResources->EarthGeoLinkShader);
+        uniforms.bind();
+        uniforms.set(g_WorldResources->EarthGeoLinkModelViewProjection, projection * view * model);
+        uniforms.set(g_WorldResources->EarthGeoLinkTint, glm::vec4(1.0, 1.0, 1.0, 1.0));
 
         Buffer& vertexBuffer = m_Curve.getVertexBuffer();
         context->geometry().bind(vertexBuffer, *g_WorldResources->EarthGeoLinkShader);
@@ -183,6 +189,13 @@ public:
 		m_SphereMaterial.setDiffuse(glm::vec4(0.1, 0.1, 0.1, 1.0));
 		m_SphereMaterial.setShininess(45.0f);
 
+		m_SphereModel = m_SphereUniforms.declare("u_ModelMatrix");
+		m_SphereNormal = m_SphereUniforms.declare("u_NormalMatrix");
+		m_SphereAmbient = m_SphereUniforms.declare("u_Material.Ambient");
+		m_SphereDiffuse = m_SphereUniforms.declare("u_Material.Diffuse");
+		m_SphereSpecular = m_SphereUniforms.declare("u_Material.Specular");
+		m_SphereShininess = m_SphereUniforms.declare("u_Material.Shininess");
+
 		g_WorldResources->Sun.setPosition(glm::vec3(100.0, 100.0, 100.0));
 
 		/*
@@ -211,16 +224,18 @@ public:
 
 #ifndef EMSCRIPTEN
         // NOTE : Not supported by WebGL
-        glEnable(GL_LINE_SMOOTH);
+        RenderState::getInstance().enable(GL_LINE_SMOOTH);
         glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
 #endif
-        glLineWidth(1.5);
+        RenderState::getInstance().lineWidth(1.5);
 
 		// static unsigned int count = 0;
 		// count++;
 		// float t = (float)count / 1000.0f;
 		// g_WorldResources->Sun.setPosition(glm::vec3(100.0 * cos(t), 0, 100.0 * sin(t)));
 
+		g_WorldResources->Frame.update(view, projection, g_WorldResources->Sun);
+
 		Transformation transformation;
 
 		transformation.set(model);
@@ -233,25 +248,20 @@ public:
 			Buffer& vertexBuffer = m_SphereMesh->getVertexBuffer();
 			Buffer& indexBuffer = m_SphereMesh->getIndexBuffer();
 
-			m_SphereShader->use();
-			m_SphereShader->uniform("u_ModelMatrix").set(transformation.state());
-			m_SphereShader->uniform("u_ViewMatrix").set(view);
-			m_SphereShader->uniform("u_ProjectionMatrix").set(projection);
+			RenderState::getInstance().use(m_SphereShader);
+			m_SphereUniforms.bind();
+			m_SphereUniforms.set(g_WorldResources->Frame);
+			m_SphereUniforms.set(m_SphereModel, transformation.state());
 			// NOTE : Normal Matrix is the transpose of the inverse of the model view matrix
 			// Using the Model View Matrix doesn't work if using non-homogeneous scales
-			m_SphereShader->uniform("u_NormalMatrix").set(glm::transpose(glm::inverse(glm::mat3(view * transformation.state()))));
+			m_SphereUniforms.set(m_SphereNormal, glm::transpose(glm::inverse(glm::mat3(view * transformation.state()))));
 
 			m_SphereShader->uniform("u_Texture").set(*m_SphereTexture);
 
-			m_SphereShader->uniform("u_Light.Type").set(g_WorldResources->Sun.getType());
-			m_SphereShader->uniform("u_Light.Position").set(g_WorldResources->Sun.getPosition());
-			m_SphereShader->uniform("u_Light.Direction").set(g_WorldResources->Sun.getDirection());
-			m_SphereShader->uniform("u_Light.Color").set(g_WorldResources->Sun.getColor());
-
-			m_SphereShader->uniform("u_Material.Ambient").set(m_SphereMaterial.getAmbient());
-			m_SphereShader->uniform("u_Material.Diffuse").set(m_SphereMaterial.getDiffuse());
-			m_SphereShader->uniform("u_Material.Specular").set(m_SphereMaterial.getSpecular());
-			m_SphereShader->uniform("u_Material.Shininess").set(m_SphereMaterial.getShininess());
+			m_SphereUniforms.set(m_SphereAmbient, m_SphereMaterial.getAmbient());
+			m_SphereUniforms.set(m_SphereDiffuse, m_SphereMaterial.getDiffuse());
+			m_SphereUniforms.set(m_SphereSpecular, m_SphereMaterial.getSpecular());
+			m_SphereUniforms.set(m_SphereShininess, m_SphereMaterial.getShininess());
 
 			context->geometry().bind(vertexBuffer, *m_SphereShader);
 			context->geometry().drawElements(GL_TRIANGLES, indexBuffer.size() / sizeof(unsigned short int), GL_UNSIGNED_SHORT, indexBuffer.ptr());
@@ -261,10 +271,10 @@ public:
 
         m_GeoNodes.draw(context, projection, view, transformation.state());
 
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_DST_ALPHA);
+        RenderState::getInstance().enable(GL_BLEND);
+        RenderState::getInstance().blendFunc(GL_SRC_ALPHA, GL_DST_ALPHA);
 		m_GeoLinks.draw(context, projection, view, transformation.state());
-		glDisable(GL_BLEND);
+		RenderState::getInstance().disable(GL_BLEND);
 	}
 
     void onAddNode(Node::ID uid, const char* label)
@@ -300,6 +310,24 @@ public:
 
         m_GeoNodes.remove(vid);
         m_NodeMap.eraseRemoteID(uid, vid);
+
+        if (NodeCompaction::needed(m_GeoNodes.size(), m_NodeMap.count()) || NodeCompaction::needed(m_GeoLinks.size(), m_LinkMap.count()))
+            compact();
+    }
+
+    // NOTE : Links point to their geopoints, only the IDs need to follow
+    void compact()
+    {
+        std::vector<unsigned long> nodeRemap;
+        std::vector<unsigned long> linkRemap;
+        unsigned long nodeCount = NodeCompaction::pack(m_GeoNodes, nodeRemap);
+        NodeCompaction::pack(m_GeoLinks, linkRemap);
+
+        for (unsigned long i = 0; i < nodeCount; i++)
+            static_cast<EarthGeoPoint*>(m_GeoNodes[i])->setID(i);
+
+        m_NodeMap.remapLocalIDs(nodeRemap);
+        m_LinkMap.remapLocalIDs(linkRemap);
     }
 
     void onSetNodeAttribute(Node::ID uid, const std::string& name, VariableType type, const std::string& value)
@@ -359,6 +387,9 @@ public:
         SpaceEdge::ID vid = m_LinkMap.getLocalID(uid);
         m_GeoLinks.remove(vid);
         m_LinkMap.eraseRemoteID(uid, vid);
+
+        if (NodeCompaction::needed(m_GeoLinks.size(), m_LinkMap.count()))
+            compact();
     }
 
     void onSetLinkAttribute(Link::ID uid, const std::string& name, VariableType type, const std::string& value)
@@ -402,6 +433,13 @@ private:
 	SphereMesh* m_SphereMesh;
 	Texture* m_SphereTexture;
 	Shader::Program* m_SphereShader;
+	UniformCache m_SphereUniforms;
+	UniformCache::Handle m_SphereModel;
+	UniformCache::Handle m_SphereNormal;
+	UniformCache::Handle m_SphereAmbient;
+	UniformCache::Handle m_SphereDiffuse;
+	UniformCache::Handle m_SphereSpecular;
+	UniformCache::Handle m_SphereShininess;
 	Material m_SphereMaterial;
 
 	Scene::NodeVector m_GeoNodes;
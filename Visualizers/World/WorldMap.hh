@@ -2,7 +2,10 @@
 
 #include <raindance/Core/Scene/Node.hh>
 
-class WorldMapGeoPoint : public Scene::Node
+#include "Core/NodeCompaction.hh"
+#include "Core/ObjectPool.hh"
+
+class WorldMapGeoPoint : public Scene::Node, public Pooled<WorldMapGeoPoint>
 {
 public:
 	WorldMapGeoPoint()
@@ -153,6 +156,16 @@ public:
 
         m_GeoNodes.remove(vid);
         m_NodeMap.eraseRemoteID(uid, vid);
+
+        if (NodeCompaction::needed(m_GeoNodes.size(), m_NodeMap.count()))
+            compact();
+    }
+
+    void compact()
+    {
+        std::vector<unsigned long> remap;
+        NodeCompaction::pack(m_GeoNodes, remap);
+        m_NodeMap.remapLocalIDs(remap);
     }
 
     void onSetNodeAttribute(Node::ID uid, const std::string& name, VariableType type, const std::string& value)
@@ -187,9 +200,9 @@ public:
 
 	void draw(GraphContext* context, const glm::mat4& projection, const glm::mat4& view, const glm::mat4& model)
 	{
-		glDisable(GL_DEPTH_TEST);
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_DST_ALPHA);
+		RenderState::getInstance().disable(GL_DEPTH_TEST);
+		RenderState::getInstance().enable(GL_BLEND);
+		RenderState::getInstance().blendFunc(GL_SRC_ALPHA, GL_DST_ALPHA);
 
 		Transformation transformation;
 
@@ -198,7 +211,7 @@ public:
 		{
 			static unsigned short int indices[] = { 0, 1, 2, 0, 2, 3 };
 
-			m_Shader->use();
+			RenderState::getInstance().use(m_Shader);
 			m_Shader->uniform("u_ModelViewProjection").set(projection * view * transformation.state());
 
 			std::vector<Texture*>::iterator it;
@@ -214,8 +227,11 @@ public:
 		transformation.translate(glm::vec3(0.0, 0.0, -1.0));
 		m_GeoNodes.draw(context, projection, view, transformation.state());
 
-		glEnable(GL_DEPTH_TEST);
-		glDisable(GL_BLEND);
+		// NOTE : Geo points are engine icons
+		RenderState::getInstance().invalidate();
+
+		RenderState::getInstance().enable(GL_DEPTH_TEST);
+		RenderState::getInstance().disable(GL_BLEND);
 	}
 
 private:
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "Core/Uniforms.hh"
+#include "Core/RenderState.hh"
+
 class WorldResources
 {
 public:
@@ -19,6 +22,16 @@ public:
 		EarthRadius = 20.0f;
 		EarthNodeSize = 0.25;
 		EarthGeoLinkShader = ResourceManager::getInstance().loadShader("curve", Assets_curve_vert, sizeof(Assets_curve_vert), Assets_curve_frag, sizeof(Assets_curve_frag));
+
+		EarthGeoPointModel = EarthGeoPointUniforms.declare("u_ModelMatrix");
+		EarthGeoPointNormal = EarthGeoPointUniforms.declare("u_NormalMatrix");
+		EarthGeoPointAmbient = EarthGeoPointUniforms.declare("u_Material.Ambient");
+		EarthGeoPointDiffuse = EarthGeoPointUniforms.declare("u_Material.Diffuse");
+		EarthGeoPointSpecular = EarthGeoPointUniforms.declare("u_Material.Specular");
+		EarthGeoPointShininess = EarthGeoPointUniforms.declare("u_Material.Shininess");
+
+		EarthGeoLinkModelViewProjection = EarthGeoLinkUniforms.declare("u_ModelViewProjection");
+		EarthGeoLinkTint = EarthGeoLinkUniforms.declare("u_Tint");
 	}
 
 	~WorldResources()
@@ -35,9 +48,22 @@ public:
 	GraphModel* Model;
 
 	Light Sun;
+	FrameUniforms Frame; // NOTE : Camera and sun of the frame being drawn
+
 	Material EarthGeoPointMaterial;
 	Shader::Program* EarthGeoPointShader;
+	UniformCache EarthGeoPointUniforms;
+	UniformCache::Handle EarthGeoPointModel;
+	UniformCache::Handle EarthGeoPointNormal;
+	UniformCache::Handle EarthGeoPointAmbient;
+	UniformCache::Handle EarthGeoPointDiffuse;
+	UniformCache::Handle EarthGeoPointSpecular;
+	UniformCache::Handle EarthGeoPointShininess;
+
     Shader::Program* EarthGeoLinkShader;
+    UniformCache EarthGeoLinkUniforms;
+    UniformCache::Handle EarthGeoLinkModelViewProjection;
+    UniformCache::Handle EarthGeoLinkTint;
     float EarthRadius;
 	Cube* EarthGeoCube;
     float EarthNodeSize;
@@ -17,8 +17,8 @@
 #include "Visualizers/World/Earth.hh"
 #include "Visualizers/World/WorldMap.hh"
 
-typedef TranslationMap<SpaceNode::ID, Node::ID> NodeTranslationMap;
-typedef TranslationMap<SpaceEdge::ID, Link::ID> LinkTranslationMap;
+typedef DenseTranslationMap<SpaceNode::ID, Node::ID> NodeTranslationMap;
+typedef DenseTranslationMap<SpaceEdge::ID, Link::ID> LinkTranslationMap;
 
 class WorldView : public GraphView
 {
@@ -81,12 +81,13 @@ public:
 	{
 		//glClearColor(0.0, 0.0, 0.0, 1.0);
 		//glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		glEnable(GL_DEPTH_TEST);
-		glDisable(GL_BLEND);
+		RenderState::getInstance().enable(GL_DEPTH_TEST);
+		RenderState::getInstance().disable(GL_BLEND);
 
 		Transformation transformation;
 
 		g_WorldResources->Starfield->draw(context(), m_Camera3D);
+		RenderState::getInstance().invalidate();
 
 		m_Earth->draw(context(), m_Camera3D.getProjectionMatrix(), m_Camera3D.getViewMatrix(), transformation.state());
 
@@ -140,6 +141,13 @@ public:
 
 	// ----- Graph Events -----
 
+	void onReserve(unsigned long nodes, unsigned long links)
+	{
+	    EarthGeoPoint::reserve(nodes);
+	    EarthGeoLink::reserve(links);
+	    WorldMapGeoPoint::reserve(nodes);
+	}
+
 	void onAddNode(Node::ID uid, const char* label)
 	{
         m_Earth->onAddNode(uid, label);
@@ -41,6 +41,7 @@ public:
 
         set(view);
         set(controller);
+        listen(entity, view);
 
         return true;
     }
@@ -57,6 +57,15 @@ xxd -i $RESOURCES/target.png >> Pack.hh
 
 xxd -i $RESOURCES/SpaceView/node-activity.png >> Pack.hh
 
+xxd -i $RESOURCES/SpaceView/edges.vert >> Pack.hh
+xxd -i $RESOURCES/SpaceView/edges.frag >> Pack.hh
+xxd -i $RESOURCES/SpaceView/picking.vert >> Pack.hh
+xxd -i $RESOURCES/SpaceView/picking.frag >> Pack.hh
+xxd -i $RESOURCES/SpaceView/density.vert >> Pack.hh
+xxd -i $RESOURCES/SpaceView/density.frag >> Pack.hh
+xxd -i $RESOURCES/SpaceView/colormap.vert >> Pack.hh
+xxd -i $RESOURCES/SpaceView/colormap.frag >> Pack.hh
+
 xxd -i $RESOURCES/SpaceView/EdgeStyles/circles.png >> Pack.hh
 xxd -i $RESOURCES/SpaceView/EdgeStyles/cross.png >> Pack.hh
 xxd -i $RESOURCES/SpaceView/EdgeStyles/dashed.png >> Pack.hh